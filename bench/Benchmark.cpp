@@ -0,0 +1,198 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+// bacteria_bench: runs registered benchmarks and reports time
+// and number of memory allocations per operation.
+// Usage: bacteria_bench [--list] [--time SECONDS] [filter ...]
+// (runs benchmarks which names contain any of filters)
+//    or: bacteria_bench --scenarios [--trusted] [filter ...]
+// (plays end-to-end scenarios, see scenarios.cpp)
+//    or: bacteria_bench --scaling [--threads N] [--trusted]
+// (plays a batch of games on 1, 2, 4, ... N threads, see scaling.cpp)
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "CoreGlobals.hpp"
+
+// minimum measured time of a benchmark (seconds)
+static const double DEFAULT_MIN_TIME = 0.2;
+
+// maximum number of iterations of a benchmark
+static const int MAX_ITERATIONS = 1000 * 1000 * 1000;
+
+struct BenchEntry {
+    std::string name;
+    BenchFunction function;
+};
+
+static std::vector<BenchEntry>& getRegistry() {
+    // constructed on first use (registrars are static objects)
+    static std::vector<BenchEntry> registry;
+    return registry;
+}
+
+static volatile long long sink;
+
+BenchState::BenchState(int iterations)
+    : iterations(iterations)
+    , start_(Clock::now())
+    , time_(0)
+    , allocations_start_(getAllocationsNumber())
+    , allocations_(0)
+    , paused_(false) {
+}
+
+void BenchState::pause() {
+    if (!paused_) {
+        std::chrono::duration<double> time = Clock::now() - start_;
+        time_ += time.count();
+        allocations_ += getAllocationsNumber() - allocations_start_;
+        paused_ = true;
+    }
+}
+
+void BenchState::resume() {
+    if (paused_) {
+        paused_ = false;
+        allocations_start_ = getAllocationsNumber();
+        start_ = Clock::now();
+    }
+}
+
+void BenchState::keep(long long value) {
+    sink = sink + value;
+}
+
+double BenchState::getTime() const {
+    return time_;
+}
+
+long long BenchState::getAllocations() const {
+    return allocations_;
+}
+
+void BenchState::finish() {
+    pause();
+}
+
+BenchRegistrar::BenchRegistrar(
+    const std::string& name,
+    BenchFunction function
+) {
+    BenchEntry entry;
+    entry.name = name;
+    entry.function = function;
+    getRegistry().push_back(entry);
+}
+
+static BenchState measure(BenchFunction function, double min_time) {
+    int iterations = 1;
+    while (true) {
+        BenchState state(iterations);
+        function(state);
+        state.finish();
+        double time = state.getTime();
+        if ((time >= min_time) || (iterations >= MAX_ITERATIONS)) {
+            return state;
+        }
+        // next attempt is expected to take 1.5 * min_time
+        double factor = (time > 0) ? (1.5 * min_time / time) : 100;
+        factor = std::min(std::max(factor, 2.0), 100.0);
+        iterations = std::min(
+            double(MAX_ITERATIONS),
+            iterations * factor
+        );
+    }
+}
+
+static bool matches(const std::string& name, const Strings& filters) {
+    if (filters.empty()) {
+        return true;
+    }
+    for (int i = 0; i < filters.size(); i++) {
+        if (name.find(filters[i]) != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    double min_time = DEFAULT_MIN_TIME;
+    bool list = false;
+    bool scenarios = false;
+    bool trusted = false;
+    bool scaling = false;
+    int threads = 0;
+    Strings filters;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--list") {
+            list = true;
+        } else if (arg == "--scenarios") {
+            scenarios = true;
+        } else if (arg == "--scaling") {
+            scaling = true;
+        } else if ((arg == "--threads") && (i + 1 < argc)) {
+            i++;
+            threads = atoi(argv[i]);
+        } else if (arg == "--trusted") {
+            trusted = true;
+        } else if ((arg == "--time") && (i + 1 < argc)) {
+            i++;
+            min_time = atof(argv[i]);
+        } else {
+            filters.push_back(arg);
+        }
+    }
+    if (scaling) {
+        return (runScaling(threads, trusted) == 0) ? 0 : 1;
+    }
+    if (scenarios) {
+        return (runScenarios(filters, trusted) == 0) ? 0 : 1;
+    }
+    const std::vector<BenchEntry>& registry = getRegistry();
+    if (!list) {
+        std::cout << std::left << std::setw(40) << "benchmark"
+                  << std::right << std::setw(12) << "iterations"
+                  << std::setw(12) << "ns/op"
+                  << std::setw(12) << "allocs/op" << std::endl;
+    }
+    int errors = 0;
+    for (int i = 0; i < registry.size(); i++) {
+        const BenchEntry& entry = registry[i];
+        if (!matches(entry.name, filters)) {
+            continue;
+        }
+        if (list) {
+            std::cout << entry.name << std::endl;
+            continue;
+        }
+        std::cout << std::left << std::setw(40) << entry.name
+                  << std::right << std::flush;
+        try {
+            BenchState state = measure(entry.function, min_time);
+            double ns = state.getTime() * 1e9 / state.iterations;
+            double allocs = double(state.getAllocations()) /
+                            state.iterations;
+            std::cout << std::setw(12) << state.iterations
+                      << std::setw(12) << std::fixed
+                      << std::setprecision(1) << ns
+                      << std::setw(12) << std::setprecision(2) << allocs
+                      << std::endl;
+        } catch (std::exception& e) {
+            std::cout << " Error: " << e.what() << std::endl;
+            errors++;
+        }
+    }
+    return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef BENCHMARK_HPP_
+#define BENCHMARK_HPP_
+
+#include <chrono>
+#include <string>
+
+#include "CoreGlobals.hpp"
+#include "AllocationCounter.hpp"
+
+/** State of a running benchmark.
+A benchmark performs state.iterations operations. Preparation
+which should not be measured is enclosed in pause() and resume().
+*/
+class BenchState {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    BenchState(int iterations);
+
+    int iterations;
+
+    void pause();
+
+    void resume();
+
+    /** Use the value, so the compiler does not remove its computation */
+    void keep(long long value);
+
+    /** Return measured time (seconds) */
+    double getTime() const;
+
+    /** Return measured number of allocations */
+    long long getAllocations() const;
+
+    /** Stop measuring (called by runner) */
+    void finish();
+
+private:
+    Clock::time_point start_;
+    double time_;
+    long long allocations_start_;
+    long long allocations_;
+    bool paused_;
+};
+
+typedef void (*BenchFunction)(BenchState& state);
+
+/** Registers benchmark function (a static object per function) */
+class BenchRegistrar {
+public:
+    BenchRegistrar(const std::string& name, BenchFunction function);
+};
+
+/** Run end-to-end scenarios (see scenarios.cpp) which names contain
+any of filters, return the number of scenarios which final state
+differs from the expected one
+*/
+int runScenarios(const Strings& filters, bool trusted);
+
+/** Play batches of games on 1, 2, 4, ... max_threads threads
+(0 means number of cores), the same number of games per thread,
+and print speedup and efficiency of throughput, return the number
+of runs which results of games differ from earlier runs
+*/
+int runScaling(int max_threads, bool trusted);
+
+#endif
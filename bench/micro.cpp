@@ -0,0 +1,303 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+// Microbenchmarks of Model accessors, LogicalChanger commands,
+// compilation of scripts and moves of Interpreter
+// (checked and trusted variants).
+
+#include <algorithm>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "Model.hpp"
+#include "Changer.hpp"
+#include "Interpreter.hpp"
+#include "ScriptGenerator.hpp"
+
+using Abstract::Point;
+using Implementation::LogicalChanger;
+using Implementation::LogicalMethod;
+
+static const int WIDTH = 100;
+static const int HEIGHT = 100;
+static const int BACTERIA = 500;
+static const int TEAMS = 4;
+
+// operations between preparations of the state of a benchmark
+static const int CHUNK = 1000;
+
+// mass of the bacterium executing commands, enough for CHUNK commands
+static const int COMMAND_MASS = 100 * 1000;
+
+// mass of the enemy attacked by str commands
+static const int ENEMY_MASS = 1000 * 1000 * 1000;
+
+// moves of all teams between restarts of the game
+static const int GAME_MOVES = 200;
+
+static const char* const SCRIPT =
+    "je 5\neat 3\njg 20 6\nright\ngo\nstr 2\nclon\n";
+
+// instructions of the generated script compiled by a benchmark
+static const int GENERATED_LENGTH = 1000;
+
+static const char* const scripts[] = {
+    "je 4\neat 5\ngo\nj 0\nstr\n",
+    "je 5\neat 3\njg 20 6\nright\ngo\nstr 2\nclon\n",
+    "je 4\neat r\nturn r\ngo 2\nstr\n",
+    "je 6\neat 2\njl 15 0\nclon\nleft 3\ngo\nstr\n",
+};
+
+// coordinates of all bacteria (in order of cells)
+static std::vector<Point> getBacteria(const Abstract::Model& model) {
+    std::vector<Point> bacteria;
+    for (int y = 0; y < model.getHeight(); y++) {
+        for (int x = 0; x < model.getWidth(); x++) {
+            if (model.cellState(Point(x, y)) == Abstract::BACTERIUM) {
+                bacteria.push_back(Point(x, y));
+            }
+        }
+    }
+    return bacteria;
+}
+
+template<typename TModel>
+static ModelPtr makeBoard(int bacteria = BACTERIA) {
+    return ModelPtr(Abstract::makeModel<TModel>(
+        WIDTH,
+        HEIGHT,
+        bacteria,
+        TEAMS
+    ));
+}
+
+template<typename TModel>
+static void cellState(BenchState& state) {
+    state.pause();
+    ModelPtr model = makeBoard<TModel>();
+    state.resume();
+    int sum = 0;
+    for (int i = 0; i < state.iterations; i++) {
+        Point point(i % WIDTH, (i / WIDTH) % HEIGHT);
+        sum += model->cellState(point);
+    }
+    state.keep(sum);
+}
+
+template<typename TModel>
+static void getMass(BenchState& state) {
+    state.pause();
+    ModelPtr model = makeBoard<TModel>();
+    state.resume();
+    int sum = 0;
+    for (int i = 0; i < state.iterations; i++) {
+        sum += model->getMass(i % TEAMS, (i / TEAMS) % BACTERIA);
+    }
+    state.keep(sum);
+}
+
+template<typename TModel>
+static void getMassByCoordinates(BenchState& state) {
+    state.pause();
+    ModelPtr model = makeBoard<TModel>();
+    std::vector<Point> bacteria = getBacteria(*model);
+    state.resume();
+    int sum = 0;
+    for (int i = 0; i < state.iterations; i++) {
+        sum += model->getMassByCoordinates(bacteria[i % bacteria.size()]);
+    }
+    state.keep(sum);
+}
+
+template<typename TModel>
+static void setCoordinates(BenchState& state) {
+    state.pause();
+    ModelPtr model = makeBoard<TModel>();
+    Point own = model->getCoordinates(0, 0);
+    Point empty(0, 0);
+    while (model->cellState(empty) != Abstract::EMPTY) {
+        empty.x++;
+    }
+    state.resume();
+    for (int i = 0; i < state.iterations; i++) {
+        model->setCoordinates(0, 0, (i % 2 == 0) ? empty : own);
+    }
+}
+
+template<typename TModel>
+static void killByCoordinates(BenchState& state) {
+    state.pause();
+    ModelPtr model = makeBoard<TModel>();
+    for (int done = 0; done < state.iterations;) {
+        state.pause();
+        model->reset(WIDTH, HEIGHT, BACTERIA, TEAMS, DEFAULT_SEED);
+        std::vector<Point> bacteria = getBacteria(*model);
+        int number = std::min<int>(bacteria.size(), state.iterations - done);
+        state.resume();
+        for (int i = 0; i < number; i++) {
+            model->killByCoordinates(bacteria[i]);
+        }
+        done += number;
+    }
+}
+
+template<typename TModel>
+static void roundEnemySearch(BenchState& state) {
+    state.pause();
+    ModelPtr model = makeBoard<TModel>();
+    std::vector<Point> bacteria = getBacteria(*model);
+    state.resume();
+    int found = 0;
+    for (int i = 0; i < state.iterations; i++) {
+        const Point& point = bacteria[i % bacteria.size()];
+        found += model->roundEnemySearch(point, i % 4, i % TEAMS);
+    }
+    state.keep(found);
+}
+
+// The command is executed by bacterium 0 of team 0 which moves
+// from the bottom of the board; the enemy is next to it.
+template<typename TModel, LogicalMethod method, int chunk>
+static void logicalCommand(BenchState& state) {
+    state.pause();
+    ModelPtr model = makeBoard<TModel>(0);
+    LogicalChanger changer(model, 0, 0);
+    for (int done = 0; done < state.iterations; done += chunk) {
+        state.pause();
+        model->reset(WIDTH, HEIGHT, 0, 2, DEFAULT_SEED);
+        model->createNewByCoordinates(
+            Point(WIDTH / 2, 0),
+            COMMAND_MASS,
+            Abstract::FORWARD,
+            0,
+            0
+        );
+        model->createNewByCoordinates(
+            Point(WIDTH / 2 + 1, 0),
+            ENEMY_MASS,
+            Abstract::FORWARD,
+            1,
+            0
+        );
+        int number = std::min(chunk, state.iterations - done);
+        state.resume();
+        for (int i = 0; i < number; i++) {
+            (changer.*method)(0);
+        }
+    }
+    state.keep(model->getTeamStats(0).mass);
+}
+
+static void bytecodeMake(BenchState& state) {
+    std::string source = SCRIPT;
+    int instructions = 0;
+    for (int i = 0; i < state.iterations; i++) {
+        instructions += Implementation::Bytecode::make(source)
+                        ->getInstructionsNumber();
+    }
+    state.keep(instructions);
+}
+
+// one operation is compilation of a line of a long generated script
+static void bytecodeMakeGenerated(BenchState& state) {
+    state.pause();
+    Implementation::ScriptGenerator generator(1, GENERATED_LENGTH);
+    std::string source = Implementation::ScriptGenerator::toSource(
+        generator.makeScript(GENERATED_LENGTH)
+    );
+    state.resume();
+    int instructions = 0;
+    for (int done = 0; done < state.iterations; done += GENERATED_LENGTH) {
+        instructions += Implementation::Bytecode::make(source)
+                        ->getInstructionsNumber();
+    }
+    state.keep(instructions);
+}
+
+// one operation is a move of one team
+template<typename TModel, typename TChanger>
+static void makeMove(BenchState& state) {
+    state.pause();
+    Implementation::Interpreter interpreter;
+    interpreter.makeBytecode(Strings(scripts, scripts + TEAMS));
+    ModelPtr model = makeBoard<TModel>();
+    std::string start = model->snapshot();
+    ChangerPtrs changers;
+    int chunk = GAME_MOVES * TEAMS;
+    for (int done = 0; done < state.iterations; done += chunk) {
+        state.pause();
+        model->restore(start);
+        changers.clear();
+        for (int team = 0; team < TEAMS; team++) {
+            int instructions = interpreter.getInstructionsNumber(team);
+            changers.push_back(ChangerPtr(
+                new TChanger(model, team, 0, instructions)
+            ));
+        }
+        int number = std::min(chunk, state.iterations - done);
+        state.resume();
+        for (int i = 0; i < number; i++) {
+            interpreter.makeMove(*changers[i % TEAMS], NULL);
+        }
+    }
+    state.keep(model->getAliveTeams());
+}
+
+typedef Implementation::Model Checked;
+typedef Implementation::TrustedModel Trusted;
+
+#define MODEL_BENCHMARK(function) \
+    static BenchRegistrar function##_checked( \
+        "model/" #function "/checked", \
+        function<Checked> \
+    ); \
+    static BenchRegistrar function##_trusted( \
+        "model/" #function "/trusted", \
+        function<Trusted> \
+    );
+
+MODEL_BENCHMARK(cellState)
+MODEL_BENCHMARK(getMass)
+MODEL_BENCHMARK(getMassByCoordinates)
+MODEL_BENCHMARK(setCoordinates)
+MODEL_BENCHMARK(killByCoordinates)
+MODEL_BENCHMARK(roundEnemySearch)
+
+#define COMMAND_BENCHMARK(command, chunk) \
+    static BenchRegistrar command##_checked( \
+        "logical/" #command "/checked", \
+        logicalCommand<Checked, &LogicalChanger::command, chunk> \
+    ); \
+    static BenchRegistrar command##_trusted( \
+        "logical/" #command "/trusted", \
+        logicalCommand<Trusted, &LogicalChanger::command, chunk> \
+    );
+
+COMMAND_BENCHMARK(eat, CHUNK)
+// bacterium goes to the top of the board in one chunk
+COMMAND_BENCHMARK(go, HEIGHT - 1)
+COMMAND_BENCHMARK(clon, CHUNK)
+COMMAND_BENCHMARK(str, CHUNK)
+COMMAND_BENCHMARK(left, CHUNK)
+COMMAND_BENCHMARK(right, CHUNK)
+COMMAND_BENCHMARK(back, CHUNK)
+COMMAND_BENCHMARK(turn, CHUNK)
+
+static BenchRegistrar bytecode_make("bytecode/make", bytecodeMake);
+static BenchRegistrar bytecode_make_generated(
+    "bytecode/make/generated-line",
+    bytecodeMakeGenerated
+);
+
+static BenchRegistrar make_move_checked(
+    "interpreter/makeMove/checked",
+    makeMove<Checked, Implementation::Changer>
+);
+static BenchRegistrar make_move_trusted(
+    "interpreter/makeMove/trusted",
+    makeMove<Trusted, Implementation::TrustedChanger>
+);
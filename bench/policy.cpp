@@ -0,0 +1,124 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+// Compare checked and trusted variants of Model and Changer:
+// plays the same game with both of them and measures time.
+
+#include <algorithm>
+
+#include "Benchmark.hpp"
+#include "Model.hpp"
+#include "Changer.hpp"
+#include "Interpreter.hpp"
+
+static const int WIDTH = 100;
+static const int HEIGHT = 100;
+static const int BACTERIA = 500;
+static const int MOVES = 200;
+
+static const char* const scripts[] = {
+    "je 4\neat 5\ngo\nj 0\nstr\n",
+    "je 5\neat 3\njg 20 6\nright\ngo\nstr 2\nclon\n",
+    "je 4\neat r\nturn r\ngo 2\nstr\n",
+    "je 6\neat 2\njl 15 0\nclon\nleft 3\ngo\nstr\n",
+};
+
+static const int TEAMS = sizeof(scripts) / sizeof(char*);
+
+// bacteria after the game played by the checked variant
+static int checked_bacteria = -1;
+
+static int countInstructions(const std::string& script) {
+    return std::count(script.begin(), script.end(), '\n');
+}
+
+// one operation is a move of all teams
+template<typename TModel, typename TChanger>
+static void playGame(BenchState& state) {
+    state.pause();
+    Strings sources(scripts, scripts + TEAMS);
+    Implementation::Interpreter interpreter;
+    interpreter.makeBytecode(sources);
+    for (int done = 0; done < state.iterations; done += MOVES) {
+        state.pause();
+        ModelPtr model(Abstract::makeModel<TModel>(
+            WIDTH,
+            HEIGHT,
+            BACTERIA,
+            TEAMS
+        ));
+        ChangerPtrs changers;
+        for (int team = 0; team < TEAMS; team++) {
+            int instructions = countInstructions(sources[team]);
+            changers.push_back(ChangerPtr(
+                new TChanger(model, team, 0, instructions)
+            ));
+        }
+        int moves = std::min(MOVES, state.iterations - done);
+        state.resume();
+        for (int move = 0; move < moves; move++) {
+            for (int team = 0; team < TEAMS; team++) {
+                interpreter.makeMove(*changers[team], NULL);
+            }
+        }
+        if (moves < MOVES) {
+            continue;
+        }
+        state.pause();
+        int bacteria = 0;
+        for (int team = 0; team < TEAMS; team++) {
+            bacteria += model->getTeamStats(team).alive;
+        }
+        if (TModel::Policy::CHECK) {
+            checked_bacteria = bacteria;
+        } else if ((checked_bacteria != -1) &&
+                   (checked_bacteria != bacteria)) {
+            throw Exception("variants played different games");
+        }
+    }
+}
+
+// one operation is reading of a bacterium by 5 accessors
+template<typename TModel>
+static void readAccessors(BenchState& state) {
+    state.pause();
+    ModelPtr model(Abstract::makeModel<TModel>(
+        WIDTH,
+        HEIGHT,
+        BACTERIA,
+        TEAMS
+    ));
+    state.resume();
+    int checksum = 0;
+    for (int i = 0; i < state.iterations; i++) {
+        int team = i % TEAMS;
+        int b = (i / TEAMS) % BACTERIA;
+        Abstract::Point p = model->getCoordinates(team, b);
+        checksum += model->getMass(team, b);
+        checksum += model->getDirection(team, b);
+        checksum += model->getMassByCoordinates(p);
+        checksum += model->cellState(p);
+    }
+    state.keep(checksum);
+}
+
+static BenchRegistrar accessors_checked(
+    "policy/accessors/checked",
+    readAccessors<Implementation::Model>
+);
+static BenchRegistrar accessors_trusted(
+    "policy/accessors/trusted",
+    readAccessors<Implementation::TrustedModel>
+);
+static BenchRegistrar game_checked(
+    "policy/game/checked",
+    playGame<Implementation::Model, Implementation::Changer>
+);
+static BenchRegistrar game_trusted(
+    "policy/game/trusted",
+    playGame<Implementation::TrustedModel, Implementation::TrustedChanger>
+);
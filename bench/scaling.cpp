@@ -0,0 +1,128 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+// Thread scaling: BatchRunner plays batches of games with 1, 2, 4, ...
+// threads, every thread gets the same number of games (a fixed batch
+// would not split evenly between some numbers of threads).
+// Speedup is the throughput relative to one thread, efficiency
+// is speedup per thread. Game i is the same in all batches and its
+// result must not depend on the number of threads.
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "Benchmark.hpp"
+#include "BatchRunner.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static const int GAMES_PER_THREAD = 8;
+static const int SCALING_MOVES = 300;
+
+static const char* const SCALING_SCRIPTS[] = {
+    "eat 11\nclon\nturn r\ngo\n",
+    "je 4\neat 5\ngo\nj 0\nstr\n",
+};
+
+static Implementation::BatchJobs makeJobs(int games, bool trusted) {
+    Implementation::BatchJobs jobs;
+    for (int i = 0; i < games; i++) {
+        Implementation::GameParams params(50, 50, 60, i + 1, trusted);
+        jobs.push_back(Implementation::BatchJob(
+            Strings(SCALING_SCRIPTS, SCALING_SCRIPTS + 2),
+            params,
+            SCALING_MOVES
+        ));
+    }
+    return jobs;
+}
+
+// compare results with known results of the same games
+// and add results of new games to them
+static bool checkResults(
+    Implementation::BatchResults& known,
+    const Implementation::BatchResults& results
+) {
+    bool equal = true;
+    for (int i = 0; i < results.size(); i++) {
+        if (i == known.size()) {
+            known.push_back(results[i]);
+        } else if ((known[i].moves != results[i].moves) ||
+                (known[i].winner != results[i].winner) ||
+                (known[i].bacteria != results[i].bacteria) ||
+                (known[i].masses != results[i].masses)) {
+            equal = false;
+        }
+    }
+    return equal;
+}
+
+int runScaling(int max_threads, bool trusted) {
+    if (max_threads <= 0) {
+        max_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    Ints threads_numbers;
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        threads_numbers.push_back(threads);
+    }
+    threads_numbers.push_back(max_threads);
+    std::cout << "games per thread: " << GAMES_PER_THREAD
+              << ", moves: " << SCALING_MOVES
+              << ", cores: " << std::thread::hardware_concurrency()
+              << std::endl;
+    std::cout << std::setw(8) << "threads"
+              << std::setw(8) << "games"
+              << std::setw(10) << "time, s"
+              << std::setw(12) << "games/sec"
+              << std::setw(14) << "moves/sec"
+              << std::setw(10) << "speedup"
+              << std::setw(12) << "efficiency"
+              << std::setw(18) << "moves/sec/thread" << std::endl;
+    Implementation::BatchResults known_results;
+    double first_throughput = 0;
+    int changed = 0;
+    for (int i = 0; i < threads_numbers.size(); i++) {
+        int threads = threads_numbers[i];
+        Implementation::BatchJobs jobs = makeJobs(
+            GAMES_PER_THREAD * threads,
+            trusted
+        );
+        // threads are started before the measurement
+        Implementation::BatchRunner runner(threads);
+        Clock::time_point start = Clock::now();
+        Implementation::BatchResults results = runner.run(jobs);
+        std::chrono::duration<double> time = Clock::now() - start;
+        long long moves = 0;
+        for (int j = 0; j < results.size(); j++) {
+            moves += results[j].moves;
+        }
+        double throughput = moves / time.count();
+        if (i == 0) {
+            first_throughput = throughput;
+        }
+        bool ok = checkResults(known_results, results);
+        if (!ok) {
+            changed++;
+        }
+        double speedup = throughput / first_throughput;
+        std::cout << std::setw(8) << threads
+                  << std::setw(8) << results.size() << std::fixed
+                  << std::setw(10) << std::setprecision(3) << time.count()
+                  << std::setw(12) << std::setprecision(1)
+                  << (results.size() / time.count())
+                  << std::setw(14) << std::setprecision(0) << throughput
+                  << std::setw(10) << std::setprecision(2) << speedup
+                  << std::setw(11) << std::setprecision(0)
+                  << (100 * speedup / threads) << "%"
+                  << std::setw(18) << (throughput / threads)
+                  << (ok ? "" : "  CHANGED") << std::endl;
+    }
+    return changed;
+}
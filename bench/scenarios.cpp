@@ -0,0 +1,180 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+// End-to-end scenarios: standard workloads played for a fixed
+// number of moves with a fixed seed. Speed and the hash of the
+// final state are reported; the hash is compared with the expected
+// one, so changes of behaviour are caught along with speed.
+// Peak RSS is the peak of the process so far; run one scenario
+// (bacteria_bench --scenarios NAME) to get its own peak.
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <sys/resource.h>
+
+#include "Benchmark.hpp"
+#include "Game.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+struct Scenario {
+    const char* name;
+    int width;
+    int height;
+    int bacteria;
+    int teams;
+    int moves;
+    // scripts of teams (repeated if there are less scripts than teams)
+    Strings scripts;
+    // Game::getStateHash() after the scenario; update it if the
+    // change of behaviour is intended
+    uint64_t expected_hash;
+};
+
+static const unsigned int SCENARIO_SEED = 1;
+
+// eats and turns until an enemy is in front, then attacks it
+static const char* const FIGHTER =
+    "je 3\neat\nright\nstr\n";
+
+static const char* const CLONER =
+    "eat 11\nclon\nturn r\ngo\n";
+
+static const char* const WANDERER =
+    "je 4\neat 5\ngo\nj 0\nstr\n";
+
+static const char* const SWITCHER =
+    "je 6\neat 2\njl 15 0\nclon\nleft 3\ngo\nstr\n";
+
+// 20 pseudo actions (jumps) and an action per move
+static std::string makeJumpLoop() {
+    std::ostringstream script;
+    for (int i = 1; i <= 20; i++) {
+        script << "j " << i << "\n";
+    }
+    script << "eat\n";
+    return script.str();
+}
+
+static std::vector<Scenario> makeScenarios() {
+    std::vector<Scenario> scenarios;
+    Scenario dense = {
+        // makeModel() allows width * height / 2 bacteria
+        "dense-500", 500, 500, 500 * 500 / 4, 2, 20,
+        Strings(1, WANDERER), 0xf26e942905207aeeULL
+    };
+    scenarios.push_back(dense);
+    Scenario clones = {
+        "clone-explosion", 200, 200, 10, 2, 300,
+        Strings(1, CLONER), 0x36026cc22f306dd4ULL
+    };
+    scenarios.push_back(clones);
+    Scenario fight = {
+        "str-fight", 100, 100, 100 * 100 / 4, 2, 300,
+        Strings(1, FIGHTER), 0xbb0888aaea1e8f9dULL
+    };
+    scenarios.push_back(fight);
+    Scenario jumps = {
+        "jump-loops", 100, 100, 1000, 2, 300,
+        Strings(1, makeJumpLoop()), 0xb9e1d02ff198d073ULL
+    };
+    scenarios.push_back(jumps);
+    Strings mixed;
+    mixed.push_back(FIGHTER);
+    mixed.push_back(CLONER);
+    mixed.push_back(WANDERER);
+    mixed.push_back(SWITCHER);
+    Scenario teams = {
+        "many-teams", 200, 200, 300, 16, 300,
+        mixed, 0xe245342b717c679bULL
+    };
+    scenarios.push_back(teams);
+    return scenarios;
+}
+
+// peak resident set size of the process (KB)
+static long getPeakRss() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static bool matches(const char* name, const Strings& filters) {
+    if (filters.empty()) {
+        return true;
+    }
+    for (int i = 0; i < filters.size(); i++) {
+        if (std::string(name).find(filters[i]) != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Play the scenario and print its line, return false if the final
+// state differs from the expected one
+static bool runScenario(const Scenario& scenario, bool trusted) {
+    Strings scripts;
+    for (int team = 0; team < scenario.teams; team++) {
+        scripts.push_back(scenario.scripts[team % scenario.scripts.size()]);
+    }
+    Implementation::GameParams params(
+        scenario.width,
+        scenario.height,
+        scenario.bacteria,
+        SCENARIO_SEED,
+        trusted
+    );
+    Implementation::Game game(scripts, params);
+    long long steps = 0;
+    Clock::time_point start = Clock::now();
+    for (int move = 0; move < scenario.moves; move++) {
+        // every alive bacterium makes a step in this move
+        // (bacteria born during the move are not counted)
+        for (int team = 0; team < scenario.teams; team++) {
+            steps += game.getBacteriaNumber(team);
+        }
+        if (!game.step()) {
+            break;
+        }
+    }
+    std::chrono::duration<double> time = Clock::now() - start;
+    uint64_t hash = game.getStateHash();
+    bool ok = (hash == scenario.expected_hash);
+    std::cout << std::left << std::setw(18) << scenario.name
+              << std::right << std::setw(7) << game.getMoveNumber()
+              << std::setw(12) << std::fixed << std::setprecision(1)
+              << (game.getMoveNumber() / time.count())
+              << std::setw(14) << std::setprecision(0)
+              << (steps / time.count())
+              << std::setw(12) << getPeakRss()
+              << "  " << std::hex << std::setw(16) << std::setfill('0')
+              << hash << std::dec << std::setfill(' ')
+              << (ok ? "  ok" : "  CHANGED") << std::endl;
+    return ok;
+}
+
+int runScenarios(const Strings& filters, bool trusted) {
+    std::vector<Scenario> scenarios = makeScenarios();
+    std::cout << std::left << std::setw(18) << "scenario"
+              << std::right << std::setw(7) << "moves"
+              << std::setw(12) << "moves/sec"
+              << std::setw(14) << "steps/sec"
+              << std::setw(12) << "peak KB"
+              << "  state hash" << std::endl;
+    int changed = 0;
+    for (int i = 0; i < scenarios.size(); i++) {
+        if (matches(scenarios[i].name, filters)) {
+            if (!runScenario(scenarios[i], trusted)) {
+                changed++;
+            }
+        }
+    }
+    return changed;
+}
@@ -57,4 +57,7 @@ const int MIN_HEIGHT = 5;
 /** Maximum height of board */
 const int MAX_HEIGHT = 500;
 
+/** Seed of random generator of Model (if not specified) */
+const unsigned int DEFAULT_SEED = 0;
+
 #endif
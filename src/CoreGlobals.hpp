@@ -8,8 +8,9 @@
 #ifndef CORE_GLOBALS_HPP_
 #define CORE_GLOBALS_HPP_
 
+#include <memory>
+#include <string>
 #include <vector>
-#include <QtCore>
 
 namespace Abstract {
 
@@ -29,25 +30,25 @@ struct PackedInstruction;
 
 struct Unit;
 
+class InstructionProfile;
+
 }
 
-typedef QSharedPointer<const Abstract::Model> ConstModelPtr;
-typedef QSharedPointer<Abstract::Model> ModelPtr;
-typedef QSharedPointer<Abstract::Interpreter> InterpreterPtr;
-typedef QSharedPointer<Abstract::Changer> ChangerPtr;
+typedef std::shared_ptr<const Abstract::Model> ConstModelPtr;
+typedef std::shared_ptr<Abstract::Model> ModelPtr;
+typedef std::shared_ptr<Abstract::Interpreter> InterpreterPtr;
+typedef std::shared_ptr<Abstract::Changer> ChangerPtr;
 typedef std::vector<ChangerPtr> ChangerPtrs;
 
-typedef QSharedPointer<Implementation::Bytecode> BytecodePtr;
+typedef std::shared_ptr<Implementation::Bytecode> BytecodePtr;
 typedef std::vector<BytecodePtr> BytecodePtrs;
 typedef std::vector<Implementation::Token> Tokens;
 typedef std::vector<Implementation::Instruction> Instructions;
 typedef std::vector<Implementation::PackedInstruction> PackedInstructions;
 
-typedef QSharedPointer<Implementation::Unit> UnitPtr;
-typedef std::vector<UnitPtr> Units;
-typedef std::vector<Units> Teams;
-
 typedef std::vector<int> Ints;
+typedef std::vector<Implementation::Unit> UnitList;
+
 typedef std::vector<bool> Bools;
 typedef std::vector<std::string> Strings;
 
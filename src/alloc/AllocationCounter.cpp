@@ -0,0 +1,65 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+// Global operator new is replaced to count allocations
+// (see AllocationCounter.hpp).
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "AllocationCounter.hpp"
+
+static std::atomic<long long> allocations(0);
+static std::atomic<long long> allocated_bytes(0);
+
+long long getAllocationsNumber() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+long long getAllocatedBytes() {
+    return allocated_bytes.load(std::memory_order_relaxed);
+}
+
+AllocationCounter::AllocationCounter()
+    : allocations_(getAllocationsNumber())
+    , bytes_(getAllocatedBytes()) {
+}
+
+long long AllocationCounter::getAllocations() const {
+    return getAllocationsNumber() - allocations_;
+}
+
+long long AllocationCounter::getBytes() const {
+    return getAllocatedBytes() - bytes_;
+}
+
+static void* allocate(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    void* memory = std::malloc((size == 0) ? 1 : size);
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
@@ -0,0 +1,38 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef ALLOCATION_COUNTER_HPP_
+#define ALLOCATION_COUNTER_HPP_
+
+/** Counting of heap allocations made through operator new.
+
+AllocationCounter.cpp replaces the global operator new and delete,
+so it is linked into the test and benchmark binaries only (not into
+the library). Allocations of all threads are counted.
+*/
+
+/** Return the number of allocations made by the process */
+long long getAllocationsNumber();
+
+/** Return the number of bytes requested by all allocations */
+long long getAllocatedBytes();
+
+/** Counts allocations made since construction */
+class AllocationCounter {
+public:
+    AllocationCounter();
+
+    long long getAllocations() const;
+
+    long long getBytes() const;
+
+private:
+    long long allocations_;
+    long long bytes_;
+};
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include "BatchRunner.hpp"
+#include "Metrics.hpp"
+
+namespace Implementation {
+
+BatchJob::BatchJob()
+    : moves(0)
+{
+}
+
+BatchJob::BatchJob(
+    const Strings& scripts,
+    const GameParams& params,
+    int moves
+)
+    : scripts(scripts)
+    , params(params)
+    , moves(moves)
+{
+}
+
+BatchResult::BatchResult()
+    : moves(0)
+    , winner(-1)
+{
+}
+
+BatchRunner::BatchRunner(int threads)
+    : pool_(threads)
+{
+    games_.resize(pool_.getThreadsNumber());
+}
+
+BatchResults BatchRunner::run(
+    const BatchJobs& jobs,
+    const Callback& callback
+) {
+    // compile in this thread: syntax errors are thrown from here
+    std::vector<BytecodePtrs> bytecode;
+    for (int i = 0; i < jobs.size(); i++) {
+        bytecode.push_back(cache_.get(jobs[i].scripts));
+    }
+    BatchResults results(jobs.size());
+    pool_.run(jobs.size(), [&](int worker, int job) {
+        runJob(worker, jobs[job], bytecode[job], results[job]);
+        if (callback) {
+            std::lock_guard<std::mutex> lock(callback_mutex_);
+            callback(job, results[job]);
+        }
+    });
+    return results;
+}
+
+int BatchRunner::getThreadsNumber() const {
+    return pool_.getThreadsNumber();
+}
+
+BytecodeCache& BatchRunner::getCache() {
+    return cache_;
+}
+
+void BatchRunner::runJob(
+    int worker,
+    const BatchJob& job,
+    const BytecodePtrs& bytecode,
+    BatchResult& result
+) {
+    GamePtr& game = games_[worker];
+    if (game) {
+        game->reset(bytecode, job.params);
+    } else {
+        game = GamePtr(new Game(bytecode, job.params));
+    }
+    result.moves = game->run(job.moves);
+    result.winner = game->getWinner();
+    int teams = game->getTeamsNumber();
+    result.bacteria.resize(teams);
+    result.masses.resize(teams);
+    for (int team = 0; team < teams; team++) {
+        result.bacteria[team] = game->getBacteriaNumber(team);
+        result.masses[team] = game->getTotalMass(team);
+    }
+    if (Metrics::isActive()) {
+        Metrics::addGame();
+    }
+}
+
+}
@@ -0,0 +1,103 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef BATCH_RUNNER_HPP_
+#define BATCH_RUNNER_HPP_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "CoreGlobals.hpp"
+#include "Game.hpp"
+#include "BytecodeCache.hpp"
+#include "ThreadPool.hpp"
+
+namespace Implementation {
+
+/** Independent game of a batch */
+struct BatchJob {
+    BatchJob();
+
+    BatchJob(
+        const Strings& scripts,
+        const GameParams& params,
+        int moves
+    );
+
+    // one script per team
+    Strings scripts;
+    GameParams params;
+    // maximum number of moves
+    int moves;
+};
+
+/** Result of a finished job */
+struct BatchResult {
+    BatchResult();
+
+    // number of played moves
+    int moves;
+    // the only team which has bacteria or -1
+    int winner;
+    // number of bacteria of each team
+    Ints bacteria;
+    // total mass of bacteria of each team
+    Ints masses;
+};
+
+typedef std::vector<BatchJob> BatchJobs;
+typedef std::vector<BatchResult> BatchResults;
+
+/** Runs many independent games on a thread pool.
+Every worker owns one Game, its model is reused between jobs.
+Scripts are compiled once (see BytecodeCache).
+Result of a job depends only on the job, not on the number
+of threads or on the order of execution.
+*/
+class BatchRunner {
+public:
+    /** Called when a job is finished: (job index, result).
+    Calls are serialized, but come from worker threads.
+    */
+    typedef std::function<void(int, const BatchResult&)> Callback;
+
+    /** Constructor
+    \param threads Number of workers (0 means number of cores)
+    */
+    BatchRunner(int threads = 0);
+
+    /** Play all jobs and return their results (in order of jobs) */
+    BatchResults run(
+        const BatchJobs& jobs,
+        const Callback& callback = Callback()
+    );
+
+    int getThreadsNumber() const;
+
+    BytecodeCache& getCache();
+
+private:
+    typedef std::unique_ptr<Game> GamePtr;
+
+    ThreadPool pool_;
+    BytecodeCache cache_;
+    std::vector<GamePtr> games_;
+    std::mutex callback_mutex_;
+
+    void runJob(
+        int worker,
+        const BatchJob& job,
+        const BytecodePtrs& bytecode,
+        BatchResult& result
+    );
+};
+
+}
+
+#endif
@@ -0,0 +1,249 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <algorithm>
+
+#include "Evolution.hpp"
+#include "Exception.hpp"
+
+namespace Implementation {
+
+EvolutionParams::EvolutionParams(
+    const GameParams& game,
+    int seeds,
+    int moves,
+    int population
+)
+    : game(game)
+    , seeds(seeds)
+    , moves(moves)
+    , population(population)
+    , elite(2)
+    , tournament(3)
+    , crossover(50)
+    , mutations(2)
+    , max_length(DEFAULT_MAX_SCRIPT_LENGTH)
+    , seed(DEFAULT_SEED)
+{
+}
+
+Individual::Individual()
+    : fitness(0)
+{
+}
+
+// score of the script which plays for the side in the game
+static double getScore(const BatchResult& result, int side) {
+    if (result.winner == side) {
+        return 1.0;
+    } else if (result.winner != -1) {
+        return 0.0;
+    }
+    long long own = std::max(result.masses[side], 0);
+    long long other = std::max(result.masses[1 - side], 0);
+    if (own + other == 0) {
+        return 0.5;
+    }
+    return double(own) / (own + other);
+}
+
+static bool isFitter(const Individual& first, const Individual& second) {
+    return first.fitness > second.fitness;
+}
+
+Evolution::Evolution(
+    const Strings& initial,
+    const Strings& opponents,
+    const EvolutionParams& params
+)
+    : params_(params)
+    , opponents_(opponents)
+    , generator_(params.seed, params.max_length)
+    , generation_(0)
+    , played_games_(0)
+{
+    bool invalid = (params.population < 1) || (params.seeds < 1) ||
+                   (params.elite < 0) ||
+                   (params.elite > params.population) ||
+                   (params.tournament < 1) ||
+                   (params.crossover < 0) || (params.crossover > 100) ||
+                   (params.mutations < 0);
+    if (invalid) {
+        throw Exception("Evolution: invalid parameters");
+    }
+    if (opponents.empty()) {
+        throw Exception("Evolution: no opponents");
+    }
+    for (int i = 0; i < initial.size(); i++) {
+        if (population_.size() == params.population) {
+            break;
+        }
+        BytecodePtr bytecode = Bytecode::make(initial[i]);
+        PackedInstructions script =
+            ScriptGenerator::fromBytecode(*bytecode);
+        if (script.empty()) {
+            throw Exception("Evolution: empty initial script");
+        }
+        population_.push_back(script);
+    }
+    int initial_number = population_.size();
+    for (int i = 0; population_.size() < params.population; i++) {
+        if (initial_number == 0) {
+            int length = 1 + generator_.random(params.max_length);
+            population_.push_back(generator_.makeScript(length));
+        } else {
+            population_.push_back(mutant(
+                population_[i % initial_number],
+                1 + generator_.random(std::max(params.mutations, 1))
+            ));
+        }
+    }
+}
+
+void Evolution::step(BatchRunner& runner) {
+    evaluate(runner);
+    breed();
+}
+
+void Evolution::run(
+    BatchRunner& runner,
+    int generations,
+    const Callback& progress
+) {
+    for (int i = 0; i < generations; i++) {
+        step(runner);
+        if (progress) {
+            progress(generation_, getBest());
+        }
+    }
+}
+
+int Evolution::getGeneration() const {
+    return generation_;
+}
+
+const Individuals& Evolution::getRanking() const {
+    return ranking_;
+}
+
+const Individual& Evolution::getBest() const {
+    if (ranking_.empty()) {
+        throw Exception("Evolution: no evaluated generations");
+    }
+    return ranking_[0];
+}
+
+long long Evolution::getPlayedGames() const {
+    return played_games_;
+}
+
+void Evolution::evaluate(BatchRunner& runner) {
+    ranking_.clear();
+    BatchJobs jobs;
+    // new script and side of the script in every job
+    Ints job_scripts;
+    Ints job_sides;
+    std::map<std::string, int> new_scripts;
+    std::vector<double> scores;
+    for (int i = 0; i < population_.size(); i++) {
+        Individual individual;
+        individual.instructions = population_[i];
+        individual.script = ScriptGenerator::toSource(population_[i]);
+        ranking_.push_back(individual);
+        const std::string& script = individual.script;
+        bool known = (fitness_.find(script) != fitness_.end()) ||
+                     (new_scripts.find(script) != new_scripts.end());
+        if (known) {
+            continue;
+        }
+        int index = scores.size();
+        new_scripts[script] = index;
+        scores.push_back(0);
+        for (int o = 0; o < opponents_.size(); o++) {
+            for (int seed = 0; seed < params_.seeds; seed++) {
+                int side = seed % 2;
+                Strings scripts(2);
+                scripts[side] = script;
+                scripts[1 - side] = opponents_[o];
+                GameParams game = params_.game;
+                game.seed += seed;
+                jobs.push_back(BatchJob(scripts, game, params_.moves));
+                job_scripts.push_back(index);
+                job_sides.push_back(side);
+            }
+        }
+    }
+    BatchResults results = runner.run(jobs);
+    for (int job = 0; job < results.size(); job++) {
+        scores[job_scripts[job]] += getScore(results[job], job_sides[job]);
+    }
+    played_games_ += jobs.size();
+    int games = opponents_.size() * params_.seeds;
+    std::map<std::string, int>::const_iterator it;
+    for (it = new_scripts.begin(); it != new_scripts.end(); ++it) {
+        fitness_[it->first] = scores[it->second] / games;
+    }
+    // only the ranking can survive, fitness of older scripts is dropped
+    std::map<std::string, double> fitness;
+    for (int i = 0; i < ranking_.size(); i++) {
+        const std::string& script = ranking_[i].script;
+        ranking_[i].fitness = fitness_[script];
+        fitness[script] = ranking_[i].fitness;
+    }
+    fitness_.swap(fitness);
+    // equal scripts keep order of the population
+    std::stable_sort(ranking_.begin(), ranking_.end(), isFitter);
+    generation_++;
+}
+
+void Evolution::breed() {
+    std::vector<PackedInstructions> next;
+    for (int i = 0; i < params_.elite; i++) {
+        next.push_back(ranking_[i].instructions);
+    }
+    while (next.size() < params_.population) {
+        if (generator_.random(100) < params_.crossover) {
+            const Individual& first = select();
+            const Individual& second = select();
+            PackedInstructions child = generator_.crossover(
+                first.instructions,
+                second.instructions
+            );
+            int mutations = generator_.random(params_.mutations + 1);
+            next.push_back(mutant(child, mutations));
+        } else {
+            // copy of a parent is mutated at least once
+            int mutations = 0;
+            if (params_.mutations > 0) {
+                mutations = 1 + generator_.random(params_.mutations);
+            }
+            next.push_back(mutant(select().instructions, mutations));
+        }
+    }
+    population_.swap(next);
+}
+
+const Individual& Evolution::select() {
+    // ranking_ is sorted, so the least index is the fittest
+    int best = generator_.random(ranking_.size());
+    for (int i = 1; i < params_.tournament; i++) {
+        best = std::min(best, generator_.random(ranking_.size()));
+    }
+    return ranking_[best];
+}
+
+PackedInstructions Evolution::mutant(
+    PackedInstructions script,
+    int mutations
+) {
+    for (int i = 0; i < mutations; i++) {
+        generator_.mutate(script);
+    }
+    return script;
+}
+
+}
@@ -0,0 +1,144 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef EVOLUTION_HPP_
+#define EVOLUTION_HPP_
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "CoreGlobals.hpp"
+#include "BatchRunner.hpp"
+#include "ScriptGenerator.hpp"
+
+namespace Implementation {
+
+/** Parameters of an evolution */
+struct EvolutionParams {
+    EvolutionParams(
+        const GameParams& game = GameParams(20, 20, 5),
+        int seeds = 2,
+        int moves = 1000,
+        int population = 32
+    );
+
+    // board, bacteria and validation of every game;
+    // seeds of games are game.seed, game.seed + 1, ...
+    GameParams game;
+    // number of games against every opponent
+    // (sides are swapped in every other game)
+    int seeds;
+    // maximum number of moves of a game
+    int moves;
+    // number of scripts in a generation
+    int population;
+    // number of the best scripts copied to the next generation
+    int elite;
+    // number of scripts competing for being a parent
+    int tournament;
+    // percent of children made by crossover of two parents
+    int crossover;
+    // maximum number of mutations of a child
+    int mutations;
+    // maximum number of instructions of a script
+    int max_length;
+    // seed of selection and variation of scripts
+    unsigned int seed;
+};
+
+/** Evaluated script */
+struct Individual {
+    Individual();
+
+    std::string script;
+    PackedInstructions instructions;
+    // average score of games: 1 for a win, 0 for a loss,
+    // share of total mass of both teams otherwise
+    double fitness;
+};
+
+typedef std::vector<Individual> Individuals;
+
+/** Genetic evolution of scripts.
+
+Every generation is evaluated by games against a fixed pool of
+opponents; all games of a generation are played by one
+BatchRunner::run(), so compiled scripts and models of workers
+are reused. Fitness depends only on the script, so fitness of
+the last generation is kept and scripts which survive (elite or
+duplicates) are not played again. The next generation consists of the elite and children
+of parents chosen by tournament selection; children are made by
+crossover and mutations of ScriptGenerator, so they are valid.
+Results depend only on the parameters, not on the number
+of threads.
+*/
+class Evolution {
+public:
+    /** Called after evaluation of a generation:
+    (number of the generation, the best script of it)
+    */
+    typedef std::function<void(int, const Individual&)> Callback;
+
+    /** Constructor
+    \param initial Scripts of the first generation (it is filled up
+    to params.population by their mutants or by random scripts)
+    \param opponents Scripts which evaluate the population
+    \param params Parameters of the evolution
+    */
+    Evolution(
+        const Strings& initial,
+        const Strings& opponents,
+        const EvolutionParams& params
+    );
+
+    /** Evaluate the current generation and make the next one */
+    void step(BatchRunner& runner);
+
+    /** Evolve the given number of generations */
+    void run(
+        BatchRunner& runner,
+        int generations,
+        const Callback& progress = Callback()
+    );
+
+    /** Return the number of evaluated generations */
+    int getGeneration() const;
+
+    /** Return the last evaluated generation (the best first) */
+    const Individuals& getRanking() const;
+
+    /** Return the best script of the last evaluated generation */
+    const Individual& getBest() const;
+
+    /** Return the number of games played by all generations */
+    long long getPlayedGames() const;
+
+private:
+    EvolutionParams params_;
+    Strings opponents_;
+    ScriptGenerator generator_;
+    std::vector<PackedInstructions> population_;
+    Individuals ranking_;
+    // fitness of scripts of the last evaluated generation
+    std::map<std::string, double> fitness_;
+    int generation_;
+    long long played_games_;
+
+    void evaluate(BatchRunner& runner);
+
+    void breed();
+
+    const Individual& select();
+
+    PackedInstructions mutant(PackedInstructions script, int mutations);
+};
+
+}
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include "ThreadPool.hpp"
+
+namespace Implementation {
+
+typedef std::unique_lock<std::mutex> UniqueLock;
+typedef std::lock_guard<std::mutex> Lock;
+
+ThreadPool::ThreadPool(int threads)
+    : task_(NULL)
+    , generation_(0)
+    , active_(0)
+    , stop_(false)
+    , failed_(false)
+{
+    if (threads <= 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads <= 0) {
+        threads = 1;
+    }
+    for (int i = 0; i < threads; i++) {
+        queues_.push_back(std::unique_ptr<Queue>(new Queue));
+    }
+    for (int i = 0; i < threads; i++) {
+        threads_.push_back(std::thread(&ThreadPool::work, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        Lock lock(mutex_);
+        stop_ = true;
+    }
+    start_.notify_all();
+    for (int i = 0; i < threads_.size(); i++) {
+        threads_[i].join();
+    }
+}
+
+int ThreadPool::getThreadsNumber() const {
+    return threads_.size();
+}
+
+void ThreadPool::run(int tasks, const Task& task) {
+    if (tasks <= 0) {
+        return;
+    }
+    int threads = threads_.size();
+    // contiguous ranges: neighbouring jobs usually share scripts
+    for (int worker = 0; worker < threads; worker++) {
+        int begin = (long long)(tasks) * worker / threads;
+        int end = (long long)(tasks) * (worker + 1) / threads;
+        Lock lock(queues_[worker]->mutex);
+        for (int i = begin; i < end; i++) {
+            queues_[worker]->tasks.push_back(i);
+        }
+    }
+    UniqueLock lock(mutex_);
+    task_ = &task;
+    failed_ = false;
+    error_ = std::exception_ptr();
+    active_ = threads;
+    generation_++;
+    start_.notify_all();
+    while (active_ > 0) {
+        done_.wait(lock);
+    }
+    task_ = NULL;
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = std::exception_ptr();
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::work(int worker) {
+    int seen = 0;
+    while (true) {
+        {
+            UniqueLock lock(mutex_);
+            while (!stop_ && (generation_ == seen)) {
+                start_.wait(lock);
+            }
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+        }
+        int task;
+        while (pop(worker, task)) {
+            try {
+                (*task_)(worker, task);
+            } catch (...) {
+                Lock lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                failed_ = true;
+            }
+        }
+        Lock lock(mutex_);
+        active_--;
+        if (active_ == 0) {
+            done_.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::pop(int worker, int& task) {
+    int threads = queues_.size();
+    for (int i = 0; i < threads; i++) {
+        Queue& queue = *queues_[(worker + i) % threads];
+        Lock lock(queue.mutex);
+        if (failed_) {
+            // drop remaining tasks
+            queue.tasks.clear();
+            continue;
+        }
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+        } else {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+        }
+        return true;
+    }
+    return false;
+}
+
+}
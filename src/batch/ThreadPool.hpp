@@ -0,0 +1,79 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef THREAD_POOL_HPP_
+#define THREAD_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Implementation {
+
+/** Work-stealing pool of persistent threads.
+Tasks are numbers 0..tasks-1. Each worker gets a contiguous
+range of tasks in its own queue and takes tasks from the front.
+A worker with an empty queue steals from the back of other queues.
+*/
+class ThreadPool {
+public:
+    /** Task function: (worker, task) */
+    typedef std::function<void(int, int)> Task;
+
+    /** Constructor
+    \param threads Number of workers (0 means number of cores)
+    */
+    ThreadPool(int threads = 0);
+
+    ~ThreadPool();
+
+    int getThreadsNumber() const;
+
+    /** Execute task(worker, i) for i in 0..tasks-1 and wait.
+    If a task throws, remaining tasks are not started and
+    the first exception is rethrown here.
+    Must not be called concurrently.
+    */
+    void run(int tasks, const Task& task);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<int> tasks;
+    };
+
+    std::vector<std::thread> threads_;
+    std::vector<std::unique_ptr<Queue> > queues_;
+
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    const Task* task_;
+    int generation_;
+    int active_;
+    bool stop_;
+
+    std::atomic<bool> failed_;
+    std::exception_ptr error_;
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    void work(int worker);
+
+    bool pop(int worker, int& task);
+};
+
+}
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <algorithm>
+
+#include "Tournament.hpp"
+#include "Exception.hpp"
+#include "random.hpp"
+
+namespace Implementation {
+
+TournamentParams::TournamentParams(
+    const GameParams& game,
+    int seeds,
+    int moves,
+    int free_for_all
+)
+    : game(game)
+    , seeds(seeds)
+    , moves(moves)
+    , free_for_all(free_for_all)
+{
+}
+
+TournamentScore::TournamentScore()
+    : games(0)
+    , wins(0)
+    , losses(0)
+    , draws(0)
+    , survived(0)
+    , mass(0)
+{
+}
+
+Tournament::Tournament(
+    const Strings& scripts,
+    const TournamentParams& params
+)
+    : scripts_number_(scripts.size())
+    , scores_(scripts.size())
+    , pair_wins_(scripts.size() * scripts.size(), 0)
+    , finished_(0)
+{
+    if (params.seeds < 1) {
+        throw Exception("Tournament: number of seeds must be positive");
+    }
+    bool too_large = params.free_for_all > scripts_number_;
+    if ((params.free_for_all == 1) || (params.free_for_all < 0) ||
+            too_large) {
+        throw Exception("Tournament: invalid size of free-for-all");
+    }
+    for (int seed = 0; seed < params.seeds; seed++) {
+        for (int s1 = 0; s1 < scripts_number_; s1++) {
+            for (int s2 = s1 + 1; s2 < scripts_number_; s2++) {
+                Ints participants;
+                if (seed % 2 == 0) {
+                    participants.push_back(s1);
+                    participants.push_back(s2);
+                } else {
+                    participants.push_back(s2);
+                    participants.push_back(s1);
+                }
+                addJob(scripts, participants, params, seed);
+            }
+        }
+    }
+    int group = params.free_for_all;
+    if (group == 0) {
+        return;
+    }
+    for (int seed = 0; seed < params.seeds; seed++) {
+        Ints order(scripts_number_);
+        for (int i = 0; i < scripts_number_; i++) {
+            order[i] = i;
+        }
+        // Fisher-Yates shuffle, reproducible for the seed
+        Random random(params.game.seed + seed);
+        for (int i = scripts_number_ - 1; i > 0; i--) {
+            std::swap(order[i], order[random.next(i + 1)]);
+        }
+        // groups are taken from the order repeated cyclically until
+        // the end of a group meets the end of the order, so every
+        // script plays lcm(scripts, group) / scripts games
+        int slots = scripts_number_;
+        while (slots % group != 0) {
+            slots += scripts_number_;
+        }
+        for (int i = 0; i < slots; i += group) {
+            Ints participants;
+            for (int j = i; j < i + group; j++) {
+                participants.push_back(order[j % scripts_number_]);
+            }
+            addJob(scripts, participants, params, seed);
+        }
+    }
+}
+
+const BatchJobs& Tournament::getJobs() const {
+    return jobs_;
+}
+
+const Ints& Tournament::getParticipants(int job) const {
+    return participants_[job];
+}
+
+void Tournament::run(
+    BatchRunner& runner,
+    const BatchRunner::Callback& progress
+) {
+    // callbacks of BatchRunner are serialized
+    runner.run(jobs_, [&](int job, const BatchResult& result) {
+        addResult(job, result);
+        if (progress) {
+            progress(job, result);
+        }
+    });
+}
+
+void Tournament::addResult(int job, const BatchResult& result) {
+    const Ints& participants = participants_[job];
+    for (int team = 0; team < participants.size(); team++) {
+        TournamentScore& score = scores_[participants[team]];
+        score.games++;
+        if (result.winner == -1) {
+            score.draws++;
+        } else if (result.winner == team) {
+            score.wins++;
+        } else {
+            score.losses++;
+        }
+        if (result.bacteria[team] > 0) {
+            score.survived++;
+        }
+        score.mass += result.masses[team];
+    }
+    if ((participants.size() == 2) && (result.winner != -1)) {
+        int winner = participants[result.winner];
+        int loser = participants[1 - result.winner];
+        pair_wins_[winner * scripts_number_ + loser]++;
+    }
+    finished_++;
+}
+
+int Tournament::getFinishedGames() const {
+    return finished_;
+}
+
+const TournamentScore& Tournament::getScore(int script) const {
+    return scores_[script];
+}
+
+int Tournament::getPairWins(int script1, int script2) const {
+    return pair_wins_[script1 * scripts_number_ + script2];
+}
+
+Ints Tournament::getRanking() const {
+    Ints ranking(scripts_number_);
+    for (int i = 0; i < scripts_number_; i++) {
+        ranking[i] = i;
+    }
+    const TournamentScores& scores = scores_;
+    std::stable_sort(
+        ranking.begin(),
+        ranking.end(),
+        [&](int s1, int s2) {
+            if (scores[s1].wins != scores[s2].wins) {
+                return scores[s1].wins > scores[s2].wins;
+            }
+            return scores[s1].mass > scores[s2].mass;
+        }
+    );
+    return ranking;
+}
+
+void Tournament::addJob(
+    const Strings& scripts,
+    const Ints& participants,
+    const TournamentParams& params,
+    int seed
+) {
+    BatchJob job;
+    for (int team = 0; team < participants.size(); team++) {
+        job.scripts.push_back(scripts[participants[team]]);
+    }
+    job.params = params.game;
+    job.params.seed = params.game.seed + seed;
+    job.moves = params.moves;
+    jobs_.push_back(job);
+    participants_.push_back(participants);
+}
+
+}
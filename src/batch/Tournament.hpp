@@ -0,0 +1,119 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef TOURNAMENT_HPP_
+#define TOURNAMENT_HPP_
+
+#include <vector>
+
+#include "CoreGlobals.hpp"
+#include "BatchRunner.hpp"
+
+namespace Implementation {
+
+/** Parameters of a tournament */
+struct TournamentParams {
+    TournamentParams(
+        const GameParams& game = GameParams(),
+        int seeds = 1,
+        int moves = 1000,
+        int free_for_all = 0
+    );
+
+    // board, bacteria and validation of every game;
+    // seeds of games are game.seed, game.seed + 1, ...
+    GameParams game;
+    // number of games of every pairing
+    int seeds;
+    // maximum number of moves of a game
+    int moves;
+    // number of teams in additional free-for-all games
+    // (0 means only pairings)
+    int free_for_all;
+};
+
+/** Results of a script in a tournament */
+struct TournamentScore {
+    TournamentScore();
+
+    int games;
+    int wins;
+    int losses;
+    // game finished without the winner
+    int draws;
+    // number of games where the script has bacteria at the end
+    int survived;
+    // total mass of bacteria at the end of games
+    long long mass;
+};
+
+typedef std::vector<TournamentScore> TournamentScores;
+
+/** Round-robin tournament.
+Every pair of scripts plays params.seeds games; sides are swapped
+in every other game. With free_for_all = k (at most the number of
+scripts), scripts are additionally shuffled for every seed and split
+into games of k teams; the shuffled order is repeated until it is
+split evenly, so every script plays the same number of free-for-all
+games (lcm(scripts, k) / scripts per seed).
+Results are aggregated as games finish.
+*/
+class Tournament {
+public:
+    /** Constructor
+    \param scripts Scripts of participants
+    \param params Parameters of the tournament
+    */
+    Tournament(const Strings& scripts, const TournamentParams& params);
+
+    const BatchJobs& getJobs() const;
+
+    /** Return participants of the job (team -> script) */
+    const Ints& getParticipants(int job) const;
+
+    /** Play all games.
+    \param runner Runner which plays the games
+    \param progress Called after aggregation of every finished game
+    */
+    void run(
+        BatchRunner& runner,
+        const BatchRunner::Callback& progress = BatchRunner::Callback()
+    );
+
+    /** Aggregate result of finished job */
+    void addResult(int job, const BatchResult& result);
+
+    int getFinishedGames() const;
+
+    const TournamentScore& getScore(int script) const;
+
+    /** Return number of wins of script1 over script2 in pairings */
+    int getPairWins(int script1, int script2) const;
+
+    /** Return scripts ordered by wins, then by mass */
+    Ints getRanking() const;
+
+private:
+    int scripts_number_;
+    BatchJobs jobs_;
+    std::vector<Ints> participants_;
+    TournamentScores scores_;
+    // pair_wins_[script1 * scripts + script2]
+    Ints pair_wins_;
+    int finished_;
+
+    void addJob(
+        const Strings& scripts,
+        const Ints& participants,
+        const TournamentParams& params,
+        int seed
+    );
+};
+
+}
+
+#endif
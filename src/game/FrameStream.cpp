@@ -0,0 +1,325 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include "FrameStream.hpp"
+#include "BinaryStream.hpp"
+
+namespace Implementation {
+
+static const char FRAMES_MAGIC[] = "BCTF";
+static const int FRAMES_MAGIC_SIZE = 4;
+static const uint32_t FRAMES_VERSION = 1;
+// magic, version, width, height, full frame interval
+static const int HEADER_SIZE = 20;
+// full flag, move, size of payload
+static const int FRAME_HEADER_SIZE = 12;
+
+FrameCell::FrameCell()
+    : team(-1)
+    , mass(0)
+    , direction(0) {
+}
+
+bool FrameCell::operator==(const FrameCell& cell) const {
+    return (team == cell.team) && (mass == cell.mass) &&
+           (direction == cell.direction);
+}
+
+bool FrameCell::operator!=(const FrameCell& cell) const {
+    return !(*this == cell);
+}
+
+Frame::Frame(int width, int height)
+    : width(width)
+    , height(height)
+    , move(0)
+    , cells(width * height) {
+}
+
+const FrameCell& Frame::getCell(int x, int y) const {
+    return cells[y * width + x];
+}
+
+void Frame::load(const Abstract::Model& model, int move) {
+    this->move = move;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            Abstract::Point point(x, y);
+            FrameCell& cell = cells[y * width + x];
+            if (model.cellState(point) == Abstract::BACTERIUM) {
+                cell.team = model.getTeamByCoordinates(point);
+                cell.mass = model.getMassByCoordinates(point);
+                cell.direction = model.getDirectionByCoordinates(point);
+            } else {
+                cell = FrameCell();
+            }
+        }
+    }
+}
+
+/* Stream: header (magic, version, width, height, full frame
+   interval), then frames: full flag, move, size of payload (32-bit
+   little-endian) and payload.
+   Payload: pairs of runs until the end of the board:
+   number of unchanged cells, then (length << 1 | kind) of the run
+   of changed cells (varints).
+   Kind 0: cells one by one: (team + 1) * 4 + direction, and for
+   bacteria difference of mass with the previous frame (or with 0
+   in full frames).
+   Kind 1 (mass shift): signed difference of mass which is added
+   to every bacterium of the run (empty cells of the run stay empty).
+   All bacteria change mass every move, so kind 1 keeps frames small.
+*/
+static const int LITERAL_RUN = 0;
+static const int SHIFT_RUN = 1;
+
+static void writeCell(
+    BinaryWriter& writer,
+    const FrameCell& cell,
+    int base_mass
+) {
+    if ((cell.direction < 0) || (cell.direction > 3)) {
+        throw Exception("Frames: invalid direction of bacterium.");
+    }
+    writer.writeVarint((cell.team + 1) * 4 + cell.direction);
+    if (cell.team >= 0) {
+        writer.writeSignedVarint(cell.mass - base_mass);
+    }
+}
+
+static void readCell(BinaryReader& reader, FrameCell& cell, bool full) {
+    int base_mass = full ? 0 : cell.mass;
+    uint32_t code = reader.readVarint();
+    cell.team = int(code / 4) - 1;
+    cell.direction = code % 4;
+    if (cell.team >= 0) {
+        cell.mass = base_mass + reader.readSignedVarint();
+    } else {
+        cell = FrameCell();
+    }
+}
+
+// the cell can be a part of a mass shift run
+static bool isShifted(const FrameCell& cell, const FrameCell& previous) {
+    return (cell.team >= 0) && (cell.team == previous.team) &&
+           (cell.direction == previous.direction) &&
+           (cell.mass != previous.mass);
+}
+
+FrameWriter::FrameWriter(
+    std::ostream& output,
+    int width,
+    int height,
+    int full_frame_interval
+)
+    : output_(output)
+    , full_frame_interval_(full_frame_interval)
+    , frames_(0)
+    , previous_(width, height)
+    , current_(width, height) {
+    if (full_frame_interval <= 0) {
+        throw Exception("Frames: full frame interval must be positive.");
+    }
+    std::string header;
+    BinaryWriter writer(header);
+    writer.writeBytes(FRAMES_MAGIC, FRAMES_MAGIC_SIZE);
+    writer.writeUint(FRAMES_VERSION);
+    writer.writeInt(width);
+    writer.writeInt(height);
+    writer.writeInt(full_frame_interval);
+    output_.write(header.data(), header.size());
+}
+
+void FrameWriter::write(const Abstract::Model& model, int move) {
+    current_.load(model, move);
+    bool full = (frames_ % full_frame_interval_ == 0);
+    const std::vector<FrameCell>& cells = current_.cells;
+    const std::vector<FrameCell>& previous = previous_.cells;
+    int size = cells.size();
+    // header is written before the payload, its size is known later
+    data_.assign(FRAME_HEADER_SIZE, 0);
+    BinaryWriter writer(data_);
+    int i = 0;
+    while (i < size) {
+        int unchanged = i;
+        while (!full && (i < size) && (cells[i] == previous[i])) {
+            i++;
+        }
+        writer.writeVarint(i - unchanged);
+        if (i == size) {
+            writer.writeVarint(0);
+            break;
+        }
+        int start = i;
+        if (!full && isShifted(cells[i], previous[i])) {
+            int shift = cells[i].mass - previous[i].mass;
+            while (i < size) {
+                bool empty = (cells[i].team < 0) &&
+                             (cells[i] == previous[i]);
+                bool shifted = isShifted(cells[i], previous[i]) &&
+                               (cells[i].mass - previous[i].mass == shift);
+                if (!empty && !shifted) {
+                    break;
+                }
+                i++;
+            }
+            writer.writeVarint(((i - start) << 1) | SHIFT_RUN);
+            writer.writeSignedVarint(shift);
+        } else {
+            while ((i < size) && (full || ((cells[i] != previous[i]) &&
+                    !isShifted(cells[i], previous[i])))) {
+                i++;
+            }
+            writer.writeVarint(((i - start) << 1) | LITERAL_RUN);
+            for (int c = start; c < i; c++) {
+                int base_mass = full ? 0 : previous[c].mass;
+                writeCell(writer, cells[c], base_mass);
+            }
+        }
+    }
+    std::string header;
+    BinaryWriter header_writer(header);
+    header_writer.writeUint(full);
+    header_writer.writeInt(move);
+    header_writer.writeUint(data_.size() - FRAME_HEADER_SIZE);
+    data_.replace(0, FRAME_HEADER_SIZE, header);
+    output_.write(data_.data(), data_.size());
+    if (!output_) {
+        throw Exception("Frames: unable to write frame.");
+    }
+    std::swap(previous_, current_);
+    frames_++;
+}
+
+int FrameWriter::getFramesNumber() const {
+    return frames_;
+}
+
+static void checkFrames(bool condition) {
+    if (!condition) {
+        throw Exception("Frames: invalid stream.");
+    }
+}
+
+static void readExactly(std::istream& input, std::string& data, int size) {
+    data.resize(size);
+    input.read(&data[0], size);
+    checkFrames(input.gcount() == size);
+}
+
+FrameReader::FrameReader(std::istream& input)
+    : input_(input)
+    , current_(-1) {
+    readExactly(input_, data_, HEADER_SIZE);
+    BinaryReader reader(data_);
+    checkFrames(reader.readBytes(FRAMES_MAGIC, FRAMES_MAGIC_SIZE));
+    if (reader.readUint() != FRAMES_VERSION) {
+        throw Exception("Frames: unsupported version.");
+    }
+    int width = reader.readInt();
+    int height = reader.readInt();
+    Abstract::checkModelParams(width, height, 0, 0);
+    reader.readInt();
+    frame_ = Frame(width, height);
+    std::streamoff begin = input_.tellg();
+    input_.seekg(0, std::ios::end);
+    std::streamoff end = input_.tellg();
+    input_.seekg(begin);
+    // index all frames
+    while (input_.tellg() < end) {
+        readExactly(input_, data_, FRAME_HEADER_SIZE);
+        BinaryReader frame_reader(data_);
+        FrameInfo info;
+        info.full = (frame_reader.readUint() != 0);
+        info.move = frame_reader.readInt();
+        info.size = frame_reader.readUint();
+        info.offset = input_.tellg();
+        checkFrames((info.size >= 0) && (info.size <= end - info.offset));
+        // the first frame is full
+        checkFrames(info.full || !frames_.empty());
+        frames_.push_back(info);
+        input_.seekg(info.size, std::ios::cur);
+    }
+    input_.clear();
+}
+
+int FrameReader::getWidth() const {
+    return frame_.width;
+}
+
+int FrameReader::getHeight() const {
+    return frame_.height;
+}
+
+int FrameReader::getFramesNumber() const {
+    return frames_.size();
+}
+
+int FrameReader::getMove(int index) const {
+    return frames_[index].move;
+}
+
+const Frame& FrameReader::read(int index) {
+    if ((index < 0) || (index >= frames_.size())) {
+        throw Exception("Frames: index of frame is out of range.");
+    }
+    int full = index;
+    while (!frames_[full].full) {
+        full--;
+    }
+    int start = full;
+    if ((current_ >= full) && (current_ <= index)) {
+        start = current_ + 1;
+    }
+    for (int i = start; i <= index; i++) {
+        apply(i);
+    }
+    return frame_;
+}
+
+void FrameReader::apply(int index) {
+    const FrameInfo& info = frames_[index];
+    // frame_ is invalid if the payload is corrupted
+    current_ = -1;
+    input_.seekg(info.offset);
+    readExactly(input_, data_, info.size);
+    BinaryReader reader(data_);
+    std::vector<FrameCell>& cells = frame_.cells;
+    int size = cells.size();
+    int i = 0;
+    while (i < size) {
+        uint32_t unchanged = reader.readVarint();
+        checkFrames(unchanged <= size - i);
+        i += unchanged;
+        uint32_t run = reader.readVarint();
+        uint32_t length = run >> 1;
+        checkFrames(length <= size - i);
+        if (length == 0) {
+            checkFrames(i == size);
+            break;
+        }
+        if ((run & 1) == SHIFT_RUN) {
+            int shift = reader.readSignedVarint();
+            for (int c = 0; c < int(length); c++) {
+                if (cells[i].team >= 0) {
+                    cells[i].mass += shift;
+                }
+                i++;
+            }
+        } else {
+            for (int c = 0; c < int(length); c++) {
+                readCell(reader, cells[i], info.full);
+                i++;
+            }
+        }
+    }
+    checkFrames(reader.atEnd());
+    frame_.move = info.move;
+    current_ = index;
+}
+
+}
@@ -0,0 +1,131 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef FRAME_STREAM_HPP_
+#define FRAME_STREAM_HPP_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "CoreGlobals.hpp"
+#include "Model.hpp"
+
+namespace Implementation {
+
+static const int DEFAULT_FULL_FRAME_INTERVAL = 100;
+
+/** Visible state of a cell of the board */
+struct FrameCell {
+    FrameCell();
+
+    bool operator==(const FrameCell& cell) const;
+
+    bool operator!=(const FrameCell& cell) const;
+
+    // team of the bacterium or -1 for empty cell
+    int team;
+    int mass;
+    int direction;
+};
+
+/** Visible state of the board after a move */
+struct Frame {
+    Frame(int width = 0, int height = 0);
+
+    const FrameCell& getCell(int x, int y) const;
+
+    /** Read state of the board from the model */
+    void load(const Abstract::Model& model, int move);
+
+    int width;
+    int height;
+    int move;
+    // cells[y * width + x]
+    std::vector<FrameCell> cells;
+};
+
+/** Writes frames of a game to a binary stream.
+Every frame stores only changed cells (runs of changed cells
+between runs of unchanged ones, numbers are varints).
+Every full_frame_interval-th frame is stored entirely,
+so a reader can start from it.
+*/
+class FrameWriter {
+public:
+    /** Constructor (writes the header of the stream)
+    \param output Stream to write to
+    \param width Width of the board
+    \param height Height of the board
+    \param full_frame_interval Number of frames between full frames
+    */
+    FrameWriter(
+        std::ostream& output,
+        int width,
+        int height,
+        int full_frame_interval = DEFAULT_FULL_FRAME_INTERVAL
+    );
+
+    /** Write state of the model after the move */
+    void write(const Abstract::Model& model, int move);
+
+    int getFramesNumber() const;
+
+private:
+    std::ostream& output_;
+    int full_frame_interval_;
+    int frames_;
+    Frame previous_;
+    Frame current_;
+    std::string data_;
+};
+
+/** Reads frames written by FrameWriter.
+The stream is indexed once; any frame is reconstructed from
+the nearest full frame before it (or from the previous
+reconstructed frame if it is closer).
+*/
+class FrameReader {
+public:
+    /** Constructor
+    \param input Stream to read from (must outlive the reader)
+    */
+    FrameReader(std::istream& input);
+
+    int getWidth() const;
+
+    int getHeight() const;
+
+    int getFramesNumber() const;
+
+    /** Return the number of the move of the frame */
+    int getMove(int index) const;
+
+    /** Reconstruct the frame */
+    const Frame& read(int index);
+
+private:
+    struct FrameInfo {
+        std::streamoff offset;
+        int size;
+        bool full;
+        int move;
+    };
+
+    std::istream& input_;
+    std::vector<FrameInfo> frames_;
+    // reconstructed frame and its index (-1 if none)
+    Frame frame_;
+    int current_;
+    std::string data_;
+
+    void apply(int index);
+};
+
+}
+
+#endif
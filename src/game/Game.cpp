@@ -0,0 +1,368 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include "Game.hpp"
+#include "BinaryStream.hpp"
+#include "hash.hpp"
+#include "Trace.hpp"
+#include "Metrics.hpp"
+
+namespace Implementation {
+
+static const char SNAPSHOT_MAGIC[] = "BCTG";
+static const int SNAPSHOT_MAGIC_SIZE = 4;
+static const uint32_t SNAPSHOT_VERSION = 1;
+
+template<typename TModel>
+static void makeModel(
+    const GameParams& params,
+    int teams,
+    ModelPtr& model
+) {
+    if (model) {
+        model->reset(
+            params.width,
+            params.height,
+            params.bacteria,
+            teams,
+            params.seed
+        );
+    } else {
+        model = ModelPtr(Abstract::makeModel<TModel>(
+            params.width,
+            params.height,
+            params.bacteria,
+            teams,
+            params.seed
+        ));
+    }
+}
+
+template<typename TChanger>
+static void makeChangers(
+    const Abstract::Interpreter& interpreter,
+    int teams,
+    const ModelPtr& model,
+    ChangerPtrs& changers
+) {
+    changers.clear();
+    for (int team = 0; team < teams; team++) {
+        int instructions = interpreter.getInstructionsNumber(team);
+        changers.push_back(ChangerPtr(
+            new TChanger(model, team, 0, instructions)
+        ));
+    }
+}
+
+GameParams::GameParams(
+    int width,
+    int height,
+    int bacteria,
+    unsigned int seed,
+    bool trusted
+)
+    : width(width)
+    , height(height)
+    , bacteria(bacteria)
+    , seed(seed)
+    , trusted(trusted)
+{
+}
+
+MemoryReport::MemoryReport()
+    : board(0)
+    , bacteria(0)
+    , changers(0)
+    , program(0)
+    , bacteria_number(0) {
+}
+
+long long MemoryReport::getTotal() const {
+    return board + bacteria + changers + program;
+}
+
+double MemoryReport::getBytesPerBacterium() const {
+    if (bacteria_number == 0) {
+        return 0;
+    }
+    return double(bacteria + changers) / bacteria_number;
+}
+
+void writeMemoryReport(std::ostream& out, const MemoryReport& report) {
+    out << "board bytes: " << report.board << std::endl;
+    out << "bacteria bytes: " << report.bacteria << std::endl;
+    out << "changer bytes: " << report.changers << std::endl;
+    out << "program bytes: " << report.program << std::endl;
+    out << "total bytes: " << report.getTotal() << std::endl;
+    out << "bytes per bacterium: " << report.getBytesPerBacterium()
+        << " (" << report.bacteria_number << " bacteria)" << std::endl;
+}
+
+Game::Game(const Strings& scripts, const GameParams& params) {
+    interpreter_.makeBytecode(scripts);
+    start(scripts.size(), params);
+}
+
+Game::Game(const BytecodePtrs& bytecode, const GameParams& params) {
+    interpreter_.setBytecode(bytecode);
+    start(bytecode.size(), params);
+}
+
+Game::Game(
+    const Strings& scripts,
+    const GameParams& params,
+    const UnitList& bacteria
+) {
+    interpreter_.makeBytecode(scripts);
+    GameParams empty_params = params;
+    empty_params.bacteria = 0;
+    start(scripts.size(), empty_params);
+    model_->populate(
+        params.width,
+        params.height,
+        scripts.size(),
+        bacteria,
+        params.seed
+    );
+    // changers know the number of bacteria of their teams
+    makeChangers(scripts.size());
+}
+
+Game::Game(const Game& parent, unsigned int seed)
+    : model_(parent.model_->fork())
+    , interpreter_(parent.interpreter_)
+    , move_number_(parent.move_number_)
+    , trusted_(parent.trusted_) {
+    interpreter_.setProfile(NULL);
+    model_->reseed(seed);
+    int teams = parent.changers_.size();
+    makeChangers(teams);
+    for (int team = 0; team < teams; team++) {
+        changers_[team]->restore(parent.changers_[team]->snapshot());
+    }
+}
+
+void Game::reset(const BytecodePtrs& bytecode, const GameParams& params) {
+    interpreter_.setBytecode(bytecode);
+    start(bytecode.size(), params);
+}
+
+bool Game::step() {
+    if (isOver()) {
+        return false;
+    }
+    TRACE_SCOPE("move", move_number_);
+    for (int team = 0; team < changers_.size(); team++) {
+        interpreter_.makeMove(*changers_[team], NULL);
+    }
+    move_number_++;
+    if (Metrics::isActive()) {
+        Metrics::addMove();
+        for (int team = 0; team < changers_.size(); team++) {
+            live_bacteria_.set(team, getBacteriaNumber(team));
+        }
+    }
+    return !isOver();
+}
+
+int Game::run(int moves) {
+    int played = 0;
+    while ((played < moves) && !isOver()) {
+        step();
+        played++;
+    }
+    return played;
+}
+
+bool Game::isOver() const {
+    int alive = getAliveTeams();
+    return (alive == 0) || ((alive == 1) && (changers_.size() > 1));
+}
+
+int Game::getMoveNumber() const {
+    return move_number_;
+}
+
+int Game::getTeamsNumber() const {
+    return changers_.size();
+}
+
+int Game::getAliveTeams() const {
+    return model_->getAliveTeams();
+}
+
+int Game::getWinner() const {
+    if (getAliveTeams() != 1) {
+        return -1;
+    }
+    for (int team = 0; team < changers_.size(); team++) {
+        if (model_->getTeamStats(team).alive > 0) {
+            return team;
+        }
+    }
+    return -1;
+}
+
+int Game::getBacteriaNumber(int team) const {
+    return model_->getTeamStats(team).alive;
+}
+
+int Game::getTotalMass(int team) const {
+    return model_->getTeamStats(team).mass;
+}
+
+Abstract::TeamStats Game::getTeamStats(int team) const {
+    return model_->getTeamStats(team);
+}
+
+ModelPtr Game::getModel() const {
+    return model_;
+}
+
+/* Image: magic, version, number of played moves, number of teams,
+   image of the model, images of the changers (as strings)
+*/
+std::string Game::snapshot() const {
+    std::string image;
+    BinaryWriter writer(image);
+    writer.writeBytes(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE);
+    writer.writeUint(SNAPSHOT_VERSION);
+    writer.writeInt(move_number_);
+    writer.writeInt(changers_.size());
+    writer.writeString(model_->snapshot());
+    for (int team = 0; team < changers_.size(); team++) {
+        writer.writeString(changers_[team]->snapshot());
+    }
+    return image;
+}
+
+void Game::restore(const std::string& image) {
+    BinaryReader reader(image);
+    if (!reader.readBytes(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE) ||
+            (reader.readUint() != SNAPSHOT_VERSION)) {
+        throw Exception("Game: invalid snapshot.");
+    }
+    int move_number = reader.readInt();
+    int teams = changers_.size();
+    if (reader.readInt() != teams) {
+        throw Exception("Game: snapshot has other number of teams.");
+    }
+    // the image is restored into a new model and new changers,
+    // they replace the state only if every part is valid
+    GameParams params(MIN_WIDTH, MIN_HEIGHT, 0, 0, trusted_);
+    ModelPtr model;
+    ChangerPtrs changers;
+    if (trusted_) {
+        makeModel<TrustedModel>(params, teams, model);
+    } else {
+        makeModel<Model>(params, teams, model);
+    }
+    model->restore(reader.readString());
+    if (model->getTeamsNumber() != teams) {
+        throw Exception("Game: snapshot has other number of teams.");
+    }
+    checkInstructions(*model);
+    if (trusted_) {
+        Implementation::makeChangers<TrustedChanger>(
+            interpreter_,
+            teams,
+            model,
+            changers
+        );
+    } else {
+        Implementation::makeChangers<Changer>(
+            interpreter_,
+            teams,
+            model,
+            changers
+        );
+    }
+    for (int team = 0; team < teams; team++) {
+        changers[team]->restore(reader.readString());
+    }
+    if (!reader.atEnd()) {
+        throw Exception("Game: invalid snapshot.");
+    }
+    model_.swap(model);
+    changers_.swap(changers);
+    move_number_ = move_number;
+}
+
+void Game::checkInstructions(const Abstract::Model& model) const {
+    for (int team = 0; team < model.getTeamsNumber(); team++) {
+        int instructions = interpreter_.getInstructionsNumber(team);
+        // places of dead bacteria are kept between moves
+        for (int b = 0; b < model.getListSize(team); b++) {
+            bool valid = !model.isAlive(team, b) ||
+                         (model.getInstruction(team, b) < instructions);
+            if (!valid) {
+                throw Exception("Game: snapshot has an instruction "
+                                "out of the script.");
+            }
+        }
+    }
+}
+
+uint64_t Game::getStateHash() const {
+    return hashBytes(snapshot());
+}
+
+void Game::setProfile(InstructionProfile* profile) {
+    interpreter_.setProfile(profile);
+}
+
+std::unique_ptr<Game> Game::fork(unsigned int seed) const {
+    return std::unique_ptr<Game>(new Game(*this, seed));
+}
+
+MemoryReport Game::getMemoryReport() const {
+    MemoryReport report;
+    Abstract::ModelMemory model_memory = model_->getMemoryUsage();
+    report.board = model_memory.board;
+    report.bacteria = model_memory.bacteria;
+    for (int team = 0; team < changers_.size(); team++) {
+        report.changers += changers_[team]->getMemoryUsage();
+        report.bacteria_number += model_->getTeamStats(team).alive;
+    }
+    report.program = interpreter_.getBytecodeMemory();
+    return report;
+}
+
+void Game::start(int teams, const GameParams& params) {
+    if (model_ && (params.trusted != trusted_)) {
+        // other type of the model is needed
+        model_.reset();
+    }
+    trusted_ = params.trusted;
+    if (trusted_) {
+        makeModel<TrustedModel>(params, teams, model_);
+    } else {
+        makeModel<Model>(params, teams, model_);
+    }
+    makeChangers(teams);
+    move_number_ = 0;
+}
+
+void Game::makeChangers(int teams) {
+    if (trusted_) {
+        Implementation::makeChangers<TrustedChanger>(
+            interpreter_,
+            teams,
+            model_,
+            changers_
+        );
+    } else {
+        Implementation::makeChangers<Changer>(
+            interpreter_,
+            teams,
+            model_,
+            changers_
+        );
+    }
+}
+
+}
@@ -0,0 +1,198 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef GAME_HPP_
+#define GAME_HPP_
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <stdint.h>
+
+#include "CoreGlobals.hpp"
+#include "CoreConstants.hpp"
+#include "Model.hpp"
+#include "Changer.hpp"
+#include "Interpreter.hpp"
+#include "Metrics.hpp"
+
+namespace Implementation {
+
+/** Parameters of a game */
+struct GameParams {
+    GameParams(
+        int width = MIN_WIDTH,
+        int height = MIN_HEIGHT,
+        int bacteria = 1,
+        unsigned int seed = DEFAULT_SEED,
+        bool trusted = false
+    );
+
+    int width;
+    int height;
+    // initial number of bacteria per team
+    int bacteria;
+    unsigned int seed;
+    // use TrustedModel and TrustedChanger (no validation)
+    bool trusted;
+};
+
+/** Heap memory used by a game (bytes) */
+struct MemoryReport {
+    MemoryReport();
+
+    // cells of the board
+    long long board;
+    // units and lists of bacteria of the model
+    long long bacteria;
+    // state of bacteria kept by changers
+    long long changers;
+    // bytecode of scripts
+    long long program;
+    // number of alive bacteria
+    int bacteria_number;
+
+    long long getTotal() const;
+
+    /** Return memory of bacteria and changers per alive bacterium */
+    double getBytesPerBacterium() const;
+};
+
+/** Print the report, one value per line */
+void writeMemoryReport(std::ostream& out, const MemoryReport& report);
+
+/** Game loop: owns model, compiled scripts and changers.
+One move of a game is one move of each team (in order of teams).
+Game is over when less than two teams have bacteria
+(or when the only team has no bacteria).
+*/
+class Game {
+public:
+    /** Constructor
+    \param scripts Scripts of teams (one script per team)
+    \param params Parameters of the game
+    */
+    Game(const Strings& scripts, const GameParams& params);
+
+    /** Constructor
+    \param bytecode Compiled scripts of teams (may be shared)
+    \param params Parameters of the game
+    */
+    Game(const BytecodePtrs& bytecode, const GameParams& params);
+
+    /** Constructor of a game with the given initial bacteria
+    (e.g. loaded from a map), see Model::populate()
+    \param scripts Scripts of teams (one script per team)
+    \param params Parameters of the game (bacteria is ignored)
+    \param bacteria Initial bacteria of all teams
+    */
+    Game(
+        const Strings& scripts,
+        const GameParams& params,
+        const UnitList& bacteria
+    );
+
+    /** Start new game reusing memory of the model */
+    void reset(const BytecodePtrs& bytecode, const GameParams& params);
+
+    /** Play one move. Return false if the game is over */
+    bool step();
+
+    /** Play moves until the game is over or moves are exhausted.
+    Return the number of played moves.
+    */
+    int run(int moves);
+
+    bool isOver() const;
+
+    /** Return the number of played moves */
+    int getMoveNumber() const;
+
+    int getTeamsNumber() const;
+
+    /** Return the number of teams which have bacteria */
+    int getAliveTeams() const;
+
+    /** Return the only team which has bacteria or -1 */
+    int getWinner() const;
+
+    int getBacteriaNumber(int team) const;
+
+    /** Return total mass of bacteria of the team */
+    int getTotalMass(int team) const;
+
+    /** Return live counters of the team (see Model::getTeamStats) */
+    Abstract::TeamStats getTeamStats(int team) const;
+
+    /** Return the model of the game.
+    Dead bacteria are removed from the model at the start of the next
+    move of their team (not at the end of a move), so between moves
+    the checked model throws from getBacteriaNumber(team) and
+    other accessors by bacterium index of a team with dead bacteria.
+    Use getTeamStats(), getAliveTeams() and accessors by coordinates
+    (cellState(), getMassByCoordinates(), ...) of the model instead.
+    */
+    ModelPtr getModel() const;
+
+    /** Binary image of the state of the game between moves:
+    number of played moves, the model and the changers.
+    Scripts and parameters are not included.
+    */
+    std::string snapshot() const;
+
+    /** Replace the state with the image made by snapshot()
+    of a game with the same scripts. The model and changers are
+    replaced by new ones (getModel() returns the new model).
+    Throws if the image is invalid, the game is not changed then.
+    */
+    void restore(const std::string& image);
+
+    /** Return hash of snapshot() */
+    uint64_t getStateHash() const;
+
+    /** Count dispatches and cycles of instructions in the profile
+    (not owned, NULL disables profiling), see InstructionProfile
+    */
+    void setProfile(InstructionProfile* profile);
+
+    MemoryReport getMemoryReport() const;
+
+    /** Return independent copy of the game which continues from
+    the current move (e.g. Monte-Carlo rollout). The model is forked
+    (see Model::fork) and restarts its random generator from the seed,
+    so forks with different seeds play different games. Changers
+    keep their state, the profile is not copied.
+    */
+    std::unique_ptr<Game> fork(unsigned int seed) const;
+
+private:
+    ModelPtr model_;
+    Interpreter interpreter_;
+    ChangerPtrs changers_;
+    int move_number_;
+    bool trusted_;
+    Metrics::LiveBacteria live_bacteria_;
+
+    Game(const Game& parent, unsigned int seed);
+
+    // copies would share the model and changers, use fork()
+    Game(const Game&);
+
+    Game& operator=(const Game&);
+
+    void start(int teams, const GameParams& params);
+
+    void makeChangers(int teams);
+
+    // throws if a live bacterium of the model refers to
+    // an instruction which is not in the script of its team
+    void checkInstructions(const Abstract::Model& model) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,390 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <sstream>
+
+#include "Lockstep.hpp"
+#include "ScriptGenerator.hpp"
+#include "random.hpp"
+
+namespace Implementation {
+
+// maximum mass of bacteria of random cases
+static const int MAX_RANDOM_MASS = 20;
+
+// numbers of random generators compared after every move
+static const int RANDOM_PROBES = 4;
+static const int RANDOM_PROBE_END = 1000000;
+
+template<typename TModel, typename TChanger>
+static Engine makeEngine(const BytecodePtrs& bytecode, const GameMap& map) {
+    Engine engine;
+    engine.interpreter = InterpreterPtr(new Interpreter);
+    engine.interpreter->setBytecode(bytecode);
+    engine.model = ModelPtr(Abstract::makeModel<TModel>(
+        map.width,
+        map.height,
+        0,
+        map.teams,
+        map.seed
+    ));
+    engine.model->populate(
+        map.width,
+        map.height,
+        map.teams,
+        map.bacteria,
+        map.seed
+    );
+    for (int team = 0; team < map.teams; team++) {
+        int instructions = engine.interpreter->getInstructionsNumber(team);
+        engine.changers.push_back(ChangerPtr(
+            new TChanger(engine.model, team, 0, instructions)
+        ));
+    }
+    return engine;
+}
+
+Engine makeCheckedEngine(const BytecodePtrs& bytecode, const GameMap& map) {
+    return makeEngine<Model, Changer>(bytecode, map);
+}
+
+Engine makeTrustedEngine(const BytecodePtrs& bytecode, const GameMap& map) {
+    return makeEngine<TrustedModel, TrustedChanger>(bytecode, map);
+}
+
+Divergence::Divergence()
+    : move(-1)
+    , team(-1)
+    , bacterium(-1) {
+}
+
+bool Divergence::found() const {
+    return !description.empty();
+}
+
+static std::string describeCell(
+    const Abstract::Model& model,
+    const Abstract::Point& cell
+) {
+    if (model.cellState(cell) == Abstract::EMPTY) {
+        return "empty";
+    }
+    std::ostringstream out;
+    out << "team " << model.getTeamByCoordinates(cell)
+        << ", mass " << model.getMassByCoordinates(cell)
+        << ", direction " << model.getDirectionByCoordinates(cell)
+        << ", instruction " << model.getInstructionByCoordinates(cell);
+    return out.str();
+}
+
+static std::string describeBacterium(
+    const Abstract::Model& model,
+    int team,
+    int bacterium
+) {
+    Abstract::Point cell = model.getCoordinates(team, bacterium);
+    std::ostringstream out;
+    out << "cell (" << cell.x << ", " << cell.y
+        << "), mass " << model.getMass(team, bacterium)
+        << ", direction " << model.getDirection(team, bacterium)
+        << ", instruction " << model.getInstruction(team, bacterium);
+    return out.str();
+}
+
+static std::string describeStats(const Abstract::TeamStats& stats) {
+    std::ostringstream out;
+    out << "alive " << stats.alive << ", mass " << stats.mass
+        << ", clones " << stats.clones << ", deaths " << stats.deaths;
+    return out.str();
+}
+
+static std::string describePair(
+    const std::string& first,
+    const std::string& second
+) {
+    return ": reference (" + first + "), tested (" + second + ")";
+}
+
+/* The first difference of observable states of the engines
+   (empty if they are equal): board cells, alive bacteria of teams
+   in their order, counters of teams, next numbers of random
+   generators, completed commands of changers. Internal layout
+   (e.g. places of units and free slots) is not compared.
+*/
+static std::string describeDifference(
+    const Engine& reference,
+    const Engine& tested
+) {
+    const Abstract::Model& model = *reference.model;
+    for (int y = 0; y < model.getHeight(); y++) {
+        for (int x = 0; x < model.getWidth(); x++) {
+            Abstract::Point cell(x, y);
+            std::string first = describeCell(model, cell);
+            std::string second = describeCell(*tested.model, cell);
+            if (first != second) {
+                std::ostringstream out;
+                out << "cell (" << x << ", " << y << ")"
+                    << describePair(first, second);
+                return out.str();
+            }
+        }
+    }
+    if (model.getAliveTeams() != tested.model->getAliveTeams()) {
+        return "numbers of alive teams differ";
+    }
+    // dead bacteria are removed from forks, states are not changed
+    ModelPtr first = reference.model->fork();
+    ModelPtr second = tested.model->fork();
+    for (int team = 0; team < first->getTeamsNumber(); team++) {
+        std::string first_stats = describeStats(first->getTeamStats(team));
+        std::string second_stats = describeStats(
+            second->getTeamStats(team)
+        );
+        if (first_stats != second_stats) {
+            std::ostringstream out;
+            out << "team " << team
+                << describePair(first_stats, second_stats);
+            return out.str();
+        }
+        first->clearBeforeMove(team);
+        second->clearBeforeMove(team);
+        for (int b = 0; b < first->getBacteriaNumber(team); b++) {
+            std::string first_bacterium = describeBacterium(
+                *first,
+                team,
+                b
+            );
+            std::string second_bacterium = describeBacterium(
+                *second,
+                team,
+                b
+            );
+            if (first_bacterium != second_bacterium) {
+                std::ostringstream out;
+                out << "bacterium " << b << " of team " << team
+                    << describePair(first_bacterium, second_bacterium);
+                return out.str();
+            }
+        }
+    }
+    for (int i = 0; i < RANDOM_PROBES; i++) {
+        if (first->random(RANDOM_PROBE_END) !=
+                second->random(RANDOM_PROBE_END)) {
+            return "random generators differ";
+        }
+    }
+    for (int team = 0; team < reference.changers.size(); team++) {
+        const Abstract::Changer& changer = *reference.changers[team];
+        if (changer.getCompletedCommands() !=
+                tested.changers[team]->getCompletedCommands()) {
+            std::ostringstream out;
+            out << "completed commands of team " << team << " differ";
+            return out.str();
+        }
+    }
+    return "";
+}
+
+LockstepChecker::LockstepChecker(
+    const Strings& scripts,
+    const GameMap& map,
+    EngineFactory reference,
+    EngineFactory tested
+)
+    : move_number_(0) {
+    if (scripts.size() != map.teams) {
+        throw Exception("Lockstep: number of scripts differs from teams.");
+    }
+    for (int team = 0; team < scripts.size(); team++) {
+        bytecode_.push_back(Bytecode::make(scripts[team]));
+    }
+    reference_ = reference(bytecode_, map);
+    tested_ = tested(bytecode_, map);
+}
+
+Divergence LockstepChecker::run(int moves) {
+    std::string difference = describeDifference(reference_, tested_);
+    if (!difference.empty()) {
+        Divergence divergence;
+        divergence.move = move_number_;
+        divergence.description = difference;
+        return divergence;
+    }
+    int teams = reference_.changers.size();
+    for (int played = 0; played < moves; played++) {
+        int alive = reference_.model->getAliveTeams();
+        if ((alive == 0) || ((alive == 1) && (teams > 1))) {
+            break;
+        }
+        for (int team = 0; team < teams; team++) {
+            // states before the move are kept to repeat it
+            EngineImage reference_image = snapshot(reference_);
+            EngineImage tested_image = snapshot(tested_);
+            reference_.interpreter->makeMove(
+                *reference_.changers[team],
+                NULL
+            );
+            std::string error;
+            try {
+                tested_.interpreter->makeMove(*tested_.changers[team], NULL);
+            } catch (std::exception& e) {
+                error = e.what();
+            }
+            if (error.empty()) {
+                difference = describeDifference(reference_, tested_);
+            } else {
+                difference = "tested engine failed: " + error;
+            }
+            if (!difference.empty()) {
+                Divergence divergence = findCommand(
+                    team,
+                    reference_image,
+                    tested_image
+                );
+                divergence.move = move_number_;
+                divergence.team = team;
+                if (!divergence.found()) {
+                    // the repeated move is equal (e.g. the difference
+                    // is made by the interpreter of the tested engine)
+                    divergence.description = difference;
+                }
+                return divergence;
+            }
+        }
+        move_number_++;
+    }
+    return Divergence();
+}
+
+int LockstepChecker::getMoveNumber() const {
+    return move_number_;
+}
+
+LockstepChecker::EngineImage LockstepChecker::snapshot(
+    const Engine& engine
+) {
+    EngineImage image;
+    image.model = engine.model->snapshot();
+    for (int team = 0; team < engine.changers.size(); team++) {
+        image.changers.push_back(engine.changers[team]->snapshot());
+    }
+    return image;
+}
+
+void LockstepChecker::restore(
+    Engine& engine,
+    const EngineImage& image,
+    int team
+) {
+    // other changers are not changed by the move of the team
+    engine.model->restore(image.model);
+    engine.changers[team]->restore(image.changers[team]);
+}
+
+// Repeat the move of the team from the images command by command
+// (like Interpreter::makeMove), the reference engine chooses
+// the commands. Commands are called directly, so differences
+// made by the interpreter of the tested engine are not
+// attributed to a command.
+Divergence LockstepChecker::findCommand(
+    int team,
+    const EngineImage& reference_image,
+    const EngineImage& tested_image
+) {
+    restore(reference_, reference_image, team);
+    restore(tested_, tested_image, team);
+    Abstract::Changer& reference = *reference_.changers[team];
+    Abstract::Changer& tested = *tested_.changers[team];
+    Divergence divergence;
+    try {
+        reference.clearBeforeMove();
+        divergence.command = "clearBeforeMove";
+        tested.clearBeforeMove();
+        divergence.description = describeDifference(reference_, tested_);
+        if (divergence.found()) {
+            return divergence;
+        }
+        int bacteria = reference.getBacteriaNumber();
+        for (int b = 0; b < bacteria; b++) {
+            while (!reference.endOfMove(b)) {
+                int instruction = reference.getInstruction(b);
+                PackedInstruction pi =
+                    bytecode_[team]->getInstruction(instruction);
+                Abstract::Params params(pi.p1, pi.p2, pi.spec);
+                ChangerMethod func = changer_functions[pi.function_id];
+                (reference.*func)(&params, b);
+                divergence.bacterium = b;
+                divergence.command = Bytecode::toSource(pi);
+                (tested.*func)(&params, b);
+                divergence.description = describeDifference(
+                    reference_,
+                    tested_
+                );
+                if (divergence.found()) {
+                    return divergence;
+                }
+            }
+        }
+    } catch (std::exception& e) {
+        divergence.description = std::string("tested engine failed: ") +
+                                 e.what();
+        return divergence;
+    }
+    // the difference is not caused by one command
+    // (the description is empty if states are equal now)
+    divergence.bacterium = -1;
+    divergence.command.clear();
+    divergence.description = describeDifference(reference_, tested_);
+    return divergence;
+}
+
+LockstepCase makeLockstepCase(
+    unsigned int seed,
+    int width,
+    int height,
+    int teams,
+    int bacteria
+) {
+    if ((bacteria * teams) > ((width * height) / 2)) {
+        throw Exception("Lockstep: too many bacteria.");
+    }
+    LockstepCase result;
+    ScriptGenerator generator(seed);
+    Ints instructions;
+    for (int team = 0; team < teams; team++) {
+        int length = 1 + generator.random(generator.getMaxLength());
+        PackedInstructions script = generator.makeScript(length);
+        result.scripts.push_back(ScriptGenerator::toSource(script));
+        instructions.push_back(script.size());
+    }
+    GameMap& map = result.map;
+    map.width = width;
+    map.height = height;
+    map.teams = teams;
+    map.seed = seed;
+    Random random(seed);
+    Bools occupied(width * height, false);
+    for (int team = 0; team < teams; team++) {
+        for (int i = 0; i < bacteria; i++) {
+            int cell;
+            do {
+                cell = random.next(width * height);
+            } while (occupied[cell]);
+            occupied[cell] = true;
+            map.bacteria.push_back(Unit(
+                Abstract::Point(cell % width, cell / width),
+                1 + random.next(MAX_RANDOM_MASS),
+                random.next(4),
+                team,
+                random.next(instructions[team])
+            ));
+        }
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,142 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef LOCKSTEP_HPP_
+#define LOCKSTEP_HPP_
+
+#include <string>
+
+#include "CoreGlobals.hpp"
+#include "Interpreter.hpp"
+#include "MapYaml.hpp"
+
+namespace Implementation {
+
+/** Model, changers and interpreter of one implementation
+of the engine */
+struct Engine {
+    ModelPtr model;
+    // one changer per team
+    ChangerPtrs changers;
+    // plays moves of the changers
+    InterpreterPtr interpreter;
+};
+
+/** Makes an engine playing the scripts on the map
+(see Model::populate) */
+typedef Engine (*EngineFactory)(
+    const BytecodePtrs& bytecode,
+    const GameMap& map
+);
+
+/** Model and Changer (checked) with Interpreter */
+Engine makeCheckedEngine(const BytecodePtrs& bytecode, const GameMap& map);
+
+/** TrustedModel and TrustedChanger with Interpreter */
+Engine makeTrustedEngine(const BytecodePtrs& bytecode, const GameMap& map);
+
+/** The first difference between two engines */
+struct Divergence {
+    Divergence();
+
+    /** Return true if engines differ */
+    bool found() const;
+
+    // move and team after which states differ
+    // (-1 if the initial states differ or there is no difference)
+    int move;
+    int team;
+    // bacterium (index in its team at the start of the move)
+    // and command of the reference engine after which states
+    // differ (-1 and empty if they are not found)
+    int bacterium;
+    std::string command;
+    // differing bacterium or part of the state
+    std::string description;
+};
+
+/** Plays the same game on two engines and compares their observable
+states (board cells, alive bacteria of teams in their order, counters
+of teams, next numbers of random generators and completed commands
+of changers) after every move of every team. Every engine plays moves by its own interpreter.
+On the first difference the move of the team is repeated
+command by command to find the command which causes it.
+*/
+class LockstepChecker {
+public:
+    /** Constructor
+    \param scripts Scripts of teams (teams of the map)
+    \param map Board and seed of the game
+    \param reference Engine which is known to be correct
+    \param tested Engine under test
+    */
+    LockstepChecker(
+        const Strings& scripts,
+        const GameMap& map,
+        EngineFactory reference,
+        EngineFactory tested
+    );
+
+    /** Play up to moves moves (until the reference game is over)
+    and return the first difference (if any).
+    Exceptions of the reference engine are rethrown, exceptions
+    of the tested engine are differences.
+    */
+    Divergence run(int moves);
+
+    int getMoveNumber() const;
+
+private:
+    // snapshots of the model and the changers (for repeating
+    // moves, states are compared by observable values)
+    struct EngineImage {
+        std::string model;
+        Strings changers;
+    };
+
+    // scripts are compiled once and shared by the engines
+    BytecodePtrs bytecode_;
+    Engine reference_;
+    Engine tested_;
+    int move_number_;
+
+    static EngineImage snapshot(const Engine& engine);
+
+    static void restore(
+        Engine& engine,
+        const EngineImage& image,
+        int team
+    );
+
+    Divergence findCommand(
+        int team,
+        const EngineImage& reference_image,
+        const EngineImage& tested_image
+    );
+};
+
+/** Random scripts and board for LockstepChecker */
+struct LockstepCase {
+    Strings scripts;
+    GameMap map;
+};
+
+/** Return random case: scripts of ScriptGenerator and bacteria
+with random cells, masses, directions and instructions
+\param bacteria Bacteria per team (at most width * height / 2 in total)
+*/
+LockstepCase makeLockstepCase(
+    unsigned int seed,
+    int width,
+    int height,
+    int teams,
+    int bacteria
+);
+
+}
+
+#endif
@@ -0,0 +1,464 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "MapYaml.hpp"
+
+namespace Implementation {
+
+// output is collected in a buffer and written by blocks of this size
+static const int WRITE_BLOCK_SIZE = 64 * 1024;
+
+GameMap::GameMap()
+    : width(0)
+    , height(0)
+    , teams(0)
+    , seed(DEFAULT_SEED) {
+}
+
+GameParams GameMap::getParams(bool trusted) const {
+    return GameParams(width, height, 0, seed, trusted);
+}
+
+/* The map is read line by line without building a document:
+   top-level lines are "key: value" (numbers) or "key:" followed
+   by a list. Items of the list "bacteria" are bacteria, either
+   in flow style ({x: 1, y: 2, ...} in one line) or in block style
+   (fields in lines indented deeper than "-"). Other lists and
+   nested blocks are skipped.
+*/
+class MapReader {
+public:
+    MapReader(GameMap& map)
+        : map_(map)
+        , line_number_(0)
+        , list_(NO_LIST)
+        , in_item_(false)
+        , item_indent_(0)
+        , fields_(0)
+        , has_teams_(false) {
+    }
+
+    void readLine(const std::string& line) {
+        line_number_++;
+        const char* begin = line.data();
+        const char* end = begin + line.size();
+        // values are numbers, so '#' always starts a comment
+        const char* comment = static_cast<const char*>(
+            std::memchr(begin, '#', line.size())
+        );
+        if (comment != NULL) {
+            end = comment;
+        }
+        while ((end > begin) && isSpace(end[-1])) {
+            end--;
+        }
+        const char* p = skipSpaces(begin, end);
+        if (p == end) {
+            return;
+        }
+        if (*p == '\t') {
+            error("tabs are not allowed in indentation");
+        }
+        int indent = p - begin;
+        if ((indent == 0) && (isKey(p, end, "---") ||
+                              isKey(p, end, "..."))) {
+            return;
+        }
+        if ((*p == '-') && ((p + 1 == end) || (p[1] == ' '))) {
+            readItem(indent, p + 1, end);
+        } else if (in_item_ && (indent > item_indent_)) {
+            if (list_ == BACTERIA_LIST) {
+                readField(p, end);
+                expectEnd(p, end);
+            }
+        } else {
+            finishItem();
+            if (indent == 0) {
+                readTopLevel(p, end);
+            } else if (list_ != OTHER_LIST) {
+                error("unexpected indentation");
+            }
+        }
+    }
+
+    void finish() {
+        finishItem();
+        if ((map_.width == 0) || (map_.height == 0)) {
+            error("width and height are required");
+        }
+        if (!has_teams_) {
+            map_.teams = 0;
+            for (int i = 0; i < map_.bacteria.size(); i++) {
+                map_.teams = std::max(
+                    map_.teams,
+                    map_.bacteria[i].team + 1
+                );
+            }
+        }
+    }
+
+private:
+    enum List {
+        NO_LIST,
+        BACTERIA_LIST,
+        // list or block which is skipped
+        OTHER_LIST,
+    };
+
+    // required fields of a bacterium
+    enum Field {
+        FIELD_X = 1,
+        FIELD_Y = 2,
+        FIELD_TEAM = 4,
+        REQUIRED_FIELDS = 7,
+    };
+
+    GameMap& map_;
+    int line_number_;
+    List list_;
+    // block style item which is being read
+    bool in_item_;
+    int item_indent_;
+    Unit unit_;
+    int fields_;
+    bool has_teams_;
+
+    static bool isSpace(char c) {
+        return (c == ' ') || (c == '\t') || (c == '\r');
+    }
+
+    static const char* skipSpaces(const char* p, const char* end) {
+        while ((p < end) && (*p == ' ')) {
+            p++;
+        }
+        return p;
+    }
+
+    static bool isKey(const char* begin, const char* end, const char* key) {
+        int length = std::strlen(key);
+        return ((end - begin) == length) &&
+               (std::memcmp(begin, key, length) == 0);
+    }
+
+    void error(const char* message) const {
+        std::ostringstream text;
+        text << "Map: line " << line_number_ << ": " << message << ".";
+        throw Exception(text.str());
+    }
+
+    void expectEnd(const char* p, const char* end) const {
+        if (skipSpaces(p, end) != end) {
+            error("unexpected characters at the end of line");
+        }
+    }
+
+    // read decimal number which is not greater than max_value
+    long long readNumber(
+        const char*& p,
+        const char* end,
+        long long max_value
+    ) const {
+        bool negative = false;
+        if ((p < end) && ((*p == '-') || (*p == '+'))) {
+            negative = (*p == '-');
+            p++;
+        }
+        if ((p == end) || (*p < '0') || (*p > '9')) {
+            error("number is expected");
+        }
+        long long value = 0;
+        while ((p < end) && (*p >= '0') && (*p <= '9')) {
+            value = value * 10 + (*p - '0');
+            if (value > max_value) {
+                error("number is too big");
+            }
+            p++;
+        }
+        return negative ? -value : value;
+    }
+
+    int readInt(const char*& p, const char* end) const {
+        return readNumber(p, end, 0x7fffffffLL);
+    }
+
+    // read "key:" and return the key (p points after ':')
+    void readKey(
+        const char*& p,
+        const char* end,
+        const char*& key_begin,
+        const char*& key_end
+    ) const {
+        key_begin = p;
+        while ((p < end) && (*p != ':')) {
+            p++;
+        }
+        if (p == end) {
+            error("'key: value' is expected");
+        }
+        key_end = p;
+        while ((key_end > key_begin) && isSpace(key_end[-1])) {
+            key_end--;
+        }
+        p++;
+    }
+
+    // read "key: value" of a bacterium
+    void readField(const char*& p, const char* end) {
+        const char* key_begin;
+        const char* key_end;
+        readKey(p, end, key_begin, key_end);
+        p = skipSpaces(p, end);
+        int value = readInt(p, end);
+        p = skipSpaces(p, end);
+        if (isKey(key_begin, key_end, "x")) {
+            unit_.coordinates.x = value;
+            fields_ |= FIELD_X;
+        } else if (isKey(key_begin, key_end, "y")) {
+            unit_.coordinates.y = value;
+            fields_ |= FIELD_Y;
+        } else if (isKey(key_begin, key_end, "team")) {
+            unit_.team = value;
+            fields_ |= FIELD_TEAM;
+        } else if (isKey(key_begin, key_end, "mass")) {
+            unit_.mass = value;
+        } else if (isKey(key_begin, key_end, "direction")) {
+            unit_.direction = value;
+        } else if (isKey(key_begin, key_end, "instruction")) {
+            unit_.instruction = value;
+        } else {
+            error("unknown field of bacterium");
+        }
+    }
+
+    void readItem(int indent, const char* p, const char* end) {
+        if (list_ == NO_LIST) {
+            error("list item outside of a list");
+        }
+        finishItem();
+        in_item_ = true;
+        item_indent_ = indent;
+        if (list_ != BACTERIA_LIST) {
+            return;
+        }
+        unit_ = Unit(Abstract::Point(0, 0), DEFAULT_MASS, 0, 0, 0);
+        fields_ = 0;
+        p = skipSpaces(p, end);
+        if ((p < end) && (*p == '{')) {
+            p = skipSpaces(p + 1, end);
+            while ((p < end) && (*p != '}')) {
+                readField(p, end);
+                if ((p < end) && (*p == ',')) {
+                    p = skipSpaces(p + 1, end);
+                } else if ((p == end) || (*p != '}')) {
+                    error("',' or '}' is expected");
+                }
+            }
+            if (p == end) {
+                error("'}' is expected");
+            }
+            expectEnd(p + 1, end);
+            finishItem();
+        } else if (p < end) {
+            readField(p, end);
+            expectEnd(p, end);
+        }
+    }
+
+    void finishItem() {
+        if (!in_item_) {
+            return;
+        }
+        in_item_ = false;
+        if (list_ != BACTERIA_LIST) {
+            return;
+        }
+        if ((fields_ & REQUIRED_FIELDS) != REQUIRED_FIELDS) {
+            error("x, y and team of bacterium are required");
+        }
+        map_.bacteria.push_back(unit_);
+    }
+
+    void readTopLevel(const char* p, const char* end) {
+        const char* key_begin;
+        const char* key_end;
+        readKey(p, end, key_begin, key_end);
+        p = skipSpaces(p, end);
+        if (p == end) {
+            // list or nested block
+            if (isKey(key_begin, key_end, "bacteria")) {
+                list_ = BACTERIA_LIST;
+            } else {
+                list_ = OTHER_LIST;
+            }
+            return;
+        }
+        list_ = NO_LIST;
+        if (isKey(p, end, "[]")) {
+            return;
+        }
+        int* target = NULL;
+        if (isKey(key_begin, key_end, "width")) {
+            target = &map_.width;
+        } else if (isKey(key_begin, key_end, "height")) {
+            target = &map_.height;
+        } else if (isKey(key_begin, key_end, "teams")) {
+            target = &map_.teams;
+            has_teams_ = true;
+        } else if (isKey(key_begin, key_end, "seed")) {
+            long long seed = readNumber(p, end, 0xffffffffLL);
+            if (seed < 0) {
+                error("seed must not be negative");
+            }
+            map_.seed = seed;
+            expectEnd(p, end);
+            return;
+        } else {
+            // other keys (e.g. results) are not a part of the map
+            return;
+        }
+        *target = readInt(p, end);
+        expectEnd(p, end);
+    }
+};
+
+void readYamlMap(std::istream& input, GameMap& map) {
+    map = GameMap();
+    MapReader reader(map);
+    std::string line;
+    while (std::getline(input, line)) {
+        reader.readLine(line);
+    }
+    reader.finish();
+}
+
+/* Writer appends text to a buffer (numbers are formatted
+   without streams) and flushes it by big blocks.
+*/
+class MapWriter {
+public:
+    MapWriter(std::ostream& output)
+        : output_(output) {
+        buffer_.reserve(WRITE_BLOCK_SIZE + 256);
+    }
+
+    ~MapWriter() {
+        flush();
+    }
+
+    MapWriter& operator<<(const char* text) {
+        buffer_ += text;
+        return *this;
+    }
+
+    MapWriter& operator<<(unsigned int value) {
+        char digits[12];
+        int size = 0;
+        do {
+            digits[size] = '0' + (value % 10);
+            size++;
+            value /= 10;
+        } while (value != 0);
+        while (size > 0) {
+            size--;
+            buffer_ += digits[size];
+        }
+        return *this;
+    }
+
+    MapWriter& operator<<(int value) {
+        if (value < 0) {
+            buffer_ += '-';
+            // unsigned negation is valid for INT_MIN too
+            return *this << (0u - static_cast<unsigned int>(value));
+        }
+        return *this << static_cast<unsigned int>(value);
+    }
+
+    // end of a line (flushes the buffer if it is big)
+    void endLine() {
+        buffer_ += '\n';
+        if (buffer_.size() >= WRITE_BLOCK_SIZE) {
+            flush();
+        }
+    }
+
+    void flush() {
+        output_.write(buffer_.data(), buffer_.size());
+        buffer_.clear();
+    }
+
+private:
+    std::ostream& output_;
+    std::string buffer_;
+};
+
+static void writeBoard(MapWriter& writer, const Abstract::Model& model) {
+    int width = model.getWidth();
+    int height = model.getHeight();
+    writer << "width: " << width;
+    writer.endLine();
+    writer << "height: " << height;
+    writer.endLine();
+    writer << "teams: " << model.getTeamsNumber();
+    writer.endLine();
+    writer << "bacteria:";
+    writer.endLine();
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            Abstract::Point point(x, y);
+            if (model.cellState(point) == Abstract::EMPTY) {
+                continue;
+            }
+            writer << "  - {x: " << x << ", y: " << y;
+            writer << ", team: " << model.getTeamByCoordinates(point);
+            writer << ", mass: " << model.getMassByCoordinates(point);
+            writer << ", direction: " <<
+                   model.getDirectionByCoordinates(point);
+            writer << ", instruction: " <<
+                   model.getInstructionByCoordinates(point) << "}";
+            writer.endLine();
+        }
+    }
+}
+
+void writeYamlMap(
+    std::ostream& output,
+    const Abstract::Model& model,
+    unsigned int seed
+) {
+    MapWriter writer(output);
+    writer << "seed: " << seed;
+    writer.endLine();
+    writeBoard(writer, model);
+}
+
+void writeYamlResult(std::ostream& output, const Game& game) {
+    MapWriter writer(output);
+    writer << "moves: " << game.getMoveNumber();
+    writer.endLine();
+    writer << "winner: " << game.getWinner();
+    writer.endLine();
+    writer << "results:";
+    writer.endLine();
+    for (int team = 0; team < game.getTeamsNumber(); team++) {
+        Abstract::TeamStats stats = game.getTeamStats(team);
+        writer << "  - {team: " << team;
+        writer << ", bacteria: " << stats.alive;
+        writer << ", mass: " << stats.mass;
+        writer << ", clones: " << stats.clones;
+        writer << ", deaths: " << stats.deaths << "}";
+        writer.endLine();
+    }
+    writeBoard(writer, *game.getModel());
+}
+
+}
@@ -0,0 +1,83 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef MAP_YAML_HPP_
+#define MAP_YAML_HPP_
+
+#include <iostream>
+
+#include "CoreGlobals.hpp"
+#include "CoreConstants.hpp"
+#include "Model.hpp"
+#include "Game.hpp"
+
+namespace Implementation {
+
+/** Board of a game with initial bacteria.
+
+YAML representation:
+
+    width: 20
+    height: 20
+    teams: 2
+    seed: 1
+    bacteria:
+      - {x: 0, y: 3, team: 0, mass: 5, direction: 1, instruction: 0}
+      - x: 7
+        y: 2
+        team: 1
+
+Fields x, y and team of a bacterium are required, default mass
+is DEFAULT_MASS, default direction and instruction are 0.
+Fields teams and seed are optional (teams is the maximum
+team + 1, seed is DEFAULT_SEED). Other top-level keys are ignored,
+so a result written by writeYamlResult() is a map too.
+*/
+struct GameMap {
+    GameMap();
+
+    /** Return parameters of a game on this map */
+    GameParams getParams(bool trusted = false) const;
+
+    int width;
+    int height;
+    int teams;
+    unsigned int seed;
+    UnitList bacteria;
+};
+
+/** Read a map line by line (supports the subset of YAML
+used by the format of GameMap). Throws Exception with
+the number of the line if the map is invalid.
+Bacteria are validated by Model::populate().
+*/
+void readYamlMap(std::istream& input, GameMap& map);
+
+/** Write the board of the model as a map (in order of cells) */
+void writeYamlMap(
+    std::ostream& output,
+    const Abstract::Model& model,
+    unsigned int seed = DEFAULT_SEED
+);
+
+/** Write results of the game followed by its board:
+
+    moves: 120
+    winner: 0
+    results:
+      - {team: 0, bacteria: 9, mass: 61, clones: 7, deaths: 3}
+      - {team: 1, bacteria: 0, mass: 0, clones: 1, deaths: 6}
+    width: 20
+    ...
+
+winner is -1 if there is no single alive team.
+*/
+void writeYamlResult(std::ostream& output, const Game& game);
+
+}
+
+#endif
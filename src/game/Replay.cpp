@@ -0,0 +1,259 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <sstream>
+
+#include "Replay.hpp"
+#include "BinaryStream.hpp"
+#include "hash.hpp"
+
+namespace Implementation {
+
+static const char REPLAY_MAGIC[] = "BCTR";
+static const int REPLAY_MAGIC_SIZE = 4;
+static const uint32_t REPLAY_VERSION = 1;
+
+// x, y, mass, direction, team, instruction
+static const int UNIT_RECORD = 24;
+
+Replay::Replay()
+    : keyframe_interval(DEFAULT_KEYFRAME_INTERVAL) {
+}
+
+int Replay::getMovesNumber() const {
+    return int(hashes.size()) - 1;
+}
+
+/* Format: magic, version, width, height, bacteria, seed, trusted,
+   initial bacteria, scripts, keyframe interval, keyframes, hashes
+   (vectors are stored as size followed by elements)
+*/
+std::string Replay::serialize() const {
+    std::string data;
+    BinaryWriter writer(data);
+    writer.writeBytes(REPLAY_MAGIC, REPLAY_MAGIC_SIZE);
+    writer.writeUint(REPLAY_VERSION);
+    writer.writeInt(params.width);
+    writer.writeInt(params.height);
+    writer.writeInt(params.bacteria);
+    writer.writeUint(params.seed);
+    writer.writeInt(params.trusted);
+    writer.writeInt(bacteria.size());
+    for (int i = 0; i < bacteria.size(); i++) {
+        const Unit& unit = bacteria[i];
+        writer.writeInt(unit.coordinates.x);
+        writer.writeInt(unit.coordinates.y);
+        writer.writeInt(unit.mass);
+        writer.writeInt(unit.direction);
+        writer.writeInt(unit.team);
+        writer.writeInt(unit.instruction);
+    }
+    writer.writeInt(scripts.size());
+    for (int i = 0; i < scripts.size(); i++) {
+        writer.writeString(scripts[i]);
+    }
+    writer.writeInt(keyframe_interval);
+    writer.writeInt(keyframes.size());
+    for (int i = 0; i < keyframes.size(); i++) {
+        writer.writeString(keyframes[i]);
+    }
+    writer.writeInt(hashes.size());
+    for (int i = 0; i < hashes.size(); i++) {
+        writer.writeUint64(hashes[i]);
+    }
+    return data;
+}
+
+static void checkReplay(bool condition) {
+    if (!condition) {
+        throw Exception("Replay: invalid data.");
+    }
+}
+
+Replay Replay::make(const std::string& data) {
+    Replay replay;
+    BinaryReader reader(data);
+    checkReplay(reader.readBytes(REPLAY_MAGIC, REPLAY_MAGIC_SIZE));
+    if (reader.readUint() != REPLAY_VERSION) {
+        throw Exception("Replay: unsupported version.");
+    }
+    replay.params.width = reader.readInt();
+    replay.params.height = reader.readInt();
+    replay.params.bacteria = reader.readInt();
+    replay.params.seed = reader.readUint();
+    replay.params.trusted = (reader.readInt() != 0);
+    int bacteria = reader.readInt();
+    checkReplay((bacteria >= 0) &&
+                (bacteria <= reader.getRemaining() / UNIT_RECORD));
+    replay.bacteria.resize(bacteria);
+    for (int i = 0; i < bacteria; i++) {
+        Unit& unit = replay.bacteria[i];
+        unit.coordinates.x = reader.readInt();
+        unit.coordinates.y = reader.readInt();
+        unit.mass = reader.readInt();
+        unit.direction = reader.readInt();
+        unit.team = reader.readInt();
+        unit.instruction = reader.readInt();
+    }
+    int scripts = reader.readInt();
+    checkReplay((scripts >= 0) && (scripts <= data.size()));
+    for (int i = 0; i < scripts; i++) {
+        replay.scripts.push_back(reader.readString());
+    }
+    replay.keyframe_interval = reader.readInt();
+    checkReplay(replay.keyframe_interval > 0);
+    int keyframes = reader.readInt();
+    checkReplay((keyframes >= 0) && (keyframes <= data.size()));
+    for (int i = 0; i < keyframes; i++) {
+        replay.keyframes.push_back(reader.readString());
+    }
+    int hashes = reader.readInt();
+    checkReplay((hashes > 0) && (hashes <= data.size()));
+    replay.hashes.resize(hashes);
+    for (int i = 0; i < hashes; i++) {
+        replay.hashes[i] = reader.readUint64();
+    }
+    int moves = replay.getMovesNumber();
+    checkReplay(keyframes == moves / replay.keyframe_interval + 1);
+    checkReplay(reader.atEnd());
+    return replay;
+}
+
+static std::unique_ptr<Game> makeGame(
+    const Strings& scripts,
+    const GameParams& params,
+    const UnitList& bacteria
+) {
+    if (bacteria.empty()) {
+        return std::unique_ptr<Game>(new Game(scripts, params));
+    } else {
+        return std::unique_ptr<Game>(new Game(scripts, params, bacteria));
+    }
+}
+
+ReplayRecorder::ReplayRecorder(
+    const Strings& scripts,
+    const GameParams& params,
+    int keyframe_interval,
+    const UnitList& bacteria
+)
+    : game_(makeGame(scripts, params, bacteria)) {
+    if (keyframe_interval <= 0) {
+        throw Exception("Replay: keyframe interval must be positive.");
+    }
+    replay_.scripts = scripts;
+    replay_.params = params;
+    replay_.bacteria = bacteria;
+    replay_.keyframe_interval = keyframe_interval;
+    record();
+}
+
+bool ReplayRecorder::step() {
+    if (game_->isOver()) {
+        return false;
+    }
+    bool result = game_->step();
+    record();
+    return result;
+}
+
+int ReplayRecorder::run(int moves) {
+    int played = 0;
+    while ((played < moves) && !game_->isOver()) {
+        step();
+        played++;
+    }
+    return played;
+}
+
+const Game& ReplayRecorder::getGame() const {
+    return *game_;
+}
+
+const Replay& ReplayRecorder::getReplay() const {
+    return replay_;
+}
+
+void ReplayRecorder::record() {
+    std::string state = game_->snapshot();
+    replay_.hashes.push_back(hashBytes(state));
+    if (game_->getMoveNumber() % replay_.keyframe_interval == 0) {
+        replay_.keyframes.push_back(state);
+    }
+}
+
+ReplayPlayer::ReplayPlayer(const Replay& replay, bool verify)
+    : replay_(replay)
+    , game_(makeGame(replay.scripts, replay.params, replay.bacteria))
+    , verify_(verify) {
+    check();
+}
+
+void ReplayPlayer::seek(int move) {
+    if ((move < 0) || (move > replay_.getMovesNumber())) {
+        throw Exception("Replay: move is out of range.");
+    }
+    int interval = replay_.keyframe_interval;
+    int keyframe = move / interval;
+    int current = game_->getMoveNumber();
+    // simulate from current state if it is closer than the keyframe
+    if ((current > move) || (current < keyframe * interval)) {
+        game_->restore(replay_.keyframes[keyframe]);
+        check();
+    }
+    while (game_->getMoveNumber() < move) {
+        step();
+    }
+}
+
+bool ReplayPlayer::step() {
+    if (game_->getMoveNumber() >= replay_.getMovesNumber()) {
+        return false;
+    }
+    game_->step();
+    check();
+    return true;
+}
+
+int ReplayPlayer::getMoveNumber() const {
+    return game_->getMoveNumber();
+}
+
+const Game& ReplayPlayer::getGame() const {
+    return *game_;
+}
+
+int ReplayPlayer::verify() {
+    // initial state is made from the seed or the map,
+    // not from the keyframe
+    game_ = makeGame(replay_.scripts, replay_.params, replay_.bacteria);
+    while (true) {
+        int move = game_->getMoveNumber();
+        if (game_->getStateHash() != replay_.hashes[move]) {
+            return move;
+        }
+        if (move == replay_.getMovesNumber()) {
+            return -1;
+        }
+        game_->step();
+    }
+}
+
+void ReplayPlayer::check() const {
+    if (!verify_) {
+        return;
+    }
+    int move = game_->getMoveNumber();
+    if (game_->getStateHash() != replay_.hashes[move]) {
+        std::ostringstream message;
+        message << "Replay: state differs from the record after move "
+                << move << ".";
+        throw Exception(message.str());
+    }
+}
+
+}
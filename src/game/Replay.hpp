@@ -0,0 +1,126 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef REPLAY_HPP_
+#define REPLAY_HPP_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "CoreGlobals.hpp"
+#include "Game.hpp"
+
+namespace Implementation {
+
+static const int DEFAULT_KEYFRAME_INTERVAL = 100;
+
+/** Recorded game: scripts, parameters (including the seed),
+initial bacteria of a map, hashes of states after every move
+and periodic keyframes.
+*/
+struct Replay {
+    Replay();
+
+    Strings scripts;
+    GameParams params;
+    // initial bacteria of a game started from a map,
+    // empty if bacteria were placed from the seed
+    UnitList bacteria;
+    // keyframes[i] is Game::snapshot() after
+    // i * keyframe_interval moves
+    int keyframe_interval;
+    Strings keyframes;
+    // hashes[move] is Game::getStateHash() after the move
+    // (hashes[0] is the hash of initial state)
+    std::vector<uint64_t> hashes;
+
+    /** Return the number of recorded moves */
+    int getMovesNumber() const;
+
+    /** Binary representation of the replay */
+    std::string serialize() const;
+
+    /** Parse data made by serialize() */
+    static Replay make(const std::string& data);
+};
+
+/** Plays a game and records it */
+class ReplayRecorder {
+public:
+    /** Constructor
+    \param scripts Scripts of teams
+    \param params Parameters of the game
+    \param keyframe_interval Number of moves between keyframes
+    \param bacteria Initial bacteria (e.g. from a map, see
+        Game constructor), empty to place bacteria from the seed
+    */
+    ReplayRecorder(
+        const Strings& scripts,
+        const GameParams& params,
+        int keyframe_interval = DEFAULT_KEYFRAME_INTERVAL,
+        const UnitList& bacteria = UnitList()
+    );
+
+    /** Play and record one move (see Game::step) */
+    bool step();
+
+    /** Play and record moves (see Game::run) */
+    int run(int moves);
+
+    const Game& getGame() const;
+
+    const Replay& getReplay() const;
+
+private:
+    std::unique_ptr<Game> game_;
+    Replay replay_;
+
+    void record();
+};
+
+/** Reproduces recorded game.
+Seek restores the nearest keyframe before the move
+and simulates the rest. In verification mode every state
+is compared with the recorded hash; mismatch throws Exception.
+*/
+class ReplayPlayer {
+public:
+    /** Constructor
+    \param replay Recorded game (must outlive the player)
+    \param verify Compare states with recorded hashes
+    */
+    ReplayPlayer(const Replay& replay, bool verify = false);
+
+    /** Go to state after the move (0 <= move <= recorded moves) */
+    void seek(int move);
+
+    /** Play next recorded move. Return false if there are no more */
+    bool step();
+
+    int getMoveNumber() const;
+
+    const Game& getGame() const;
+
+    /** Play the whole replay from the beginning and return
+    the first move which state differs from the record
+    or -1 if all states are equal.
+    */
+    int verify();
+
+private:
+    const Replay& replay_;
+    std::unique_ptr<Game> game_;
+    bool verify_;
+
+    void check() const;
+};
+
+}
+
+#endif
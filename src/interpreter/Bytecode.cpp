@@ -5,7 +5,10 @@
  * See the LICENSE file for terms of use.
  */
 
+#include <cstring>
+
 #include "Bytecode.hpp"
+#include "CoreConstants.hpp"
 
 namespace Implementation {
 
@@ -127,7 +130,7 @@ static bool searchId(int id, const int* array, int size) {
     return false;
 }
 
-static void checkById(int id, int params, int specs) {
+static bool checkArguments(int id, int params, int specs) {
     bool ok = false;
     if ((params == 2) && (specs == 0)) {
         int size = sizeof(two_parameter_functions) / sizeof(int);
@@ -142,7 +145,11 @@ static void checkById(int id, int params, int specs) {
         int size = sizeof(non_argument_functions) / sizeof(int);
         ok = searchId(id, non_argument_functions, size);
     }
-    if (!ok) {
+    return ok;
+}
+
+static void checkById(int id, int params, int specs) {
+    if (!checkArguments(id, params, specs)) {
         throw Exception("Interpreter: invalid arguments of function");
     }
 }
@@ -168,6 +175,36 @@ static Instruction makeInstruction(
     return instruction;
 }
 
+// Numbers of commands and targets of jumps are checked here,
+// so TrustedChanger can execute compiled scripts (the same ranges
+// as checks of Changer).
+static void checkRanges(
+    const PackedInstruction& instruction,
+    int instructions
+) {
+    const char* name = functions_registry[instruction.function_id];
+    int target = -1;
+    if ((std::strcmp(name, "j") == 0) || (std::strcmp(name, "je") == 0)) {
+        target = instruction.p1;
+    } else if ((std::strcmp(name, "jg") == 0) ||
+               (std::strcmp(name, "jl") == 0)) {
+        // the first parameter is a mass
+        target = instruction.p2;
+    } else if (instruction.p1 != -1) {
+        bool greater = instruction.p1 > MIN_COMMANDS_PER_INSTRUCTION;
+        bool less = instruction.p1 < MAX_COMMANDS_PER_INSTRUCTION;
+        if (!greater || !less) {
+            throw Exception("Interpreter: invalid commands number.");
+        }
+        return;
+    } else {
+        return;
+    }
+    if ((target < 0) || (target >= instructions)) {
+        throw Exception("Interpreter: invalid target of jump.");
+    }
+}
+
 Token::Token(
     Type type,
     int parameter,
@@ -225,6 +262,62 @@ PackedInstruction Bytecode::getInstruction(int index) const {
     return bytecode_[index];
 }
 
+int Bytecode::getInstructionsNumber() const {
+    return bytecode_.size();
+}
+
+long long Bytecode::getMemoryUsage() const {
+    long long instructions = bytecode_.capacity();
+    return sizeof(Bytecode) + instructions * sizeof(PackedInstruction);
+}
+
+int Bytecode::getFunctionsNumber() {
+    return sizeof(functions_registry) / sizeof(char*);
+}
+
+const char* Bytecode::getFunctionName(int function_id) {
+    if ((function_id < 0) || (function_id >= getFunctionsNumber())) {
+        throw Exception("Bytecode: invalid function ID.");
+    }
+    return functions_registry[function_id];
+}
+
+bool Bytecode::acceptsArguments(int function_id, int params, int specs) {
+    bool exists = (function_id >= 0) &&
+                  (function_id < getFunctionsNumber());
+    return exists && checkArguments(function_id, params, specs);
+}
+
+std::string Bytecode::toSource(const PackedInstruction& instruction) {
+    std::ostringstream source;
+    source << getFunctionName(instruction.function_id);
+    if (instruction.p1 != -1) {
+        source << ' ' << instruction.p1;
+    }
+    if (instruction.p2 != -1) {
+        source << ' ' << instruction.p2;
+    }
+    if (instruction.spec) {
+        source << ' ' << specifications_registry[0];
+    }
+    return source.str();
+}
+
+Ints Bytecode::getSourceLines(const std::string& source) {
+    // the same lines as in lexer()
+    std::stringstream s_stream(source);
+    std::string line;
+    Ints result;
+    for (int number = 1; std::getline(s_stream, line); number++) {
+        Strings tokens_str;
+        split(line, ' ', tokens_str);
+        if (!tokens_str.empty()) {
+            result.push_back(number);
+        }
+    }
+    return result;
+}
+
 void Bytecode::generateBytecode(const std::string& source) {
     Tokens tokens = lexer(source);
     Instructions ast = parser(tokens);
@@ -281,6 +374,7 @@ void Bytecode::compile(const Instructions& instructions) {
         int p2 = instructions[i].p2.parameter;
         bool spec = instructions[i].spec.spec;
         PackedInstruction packed_inst(func_id, p1, p2, spec);
+        checkRanges(packed_inst, instructions.size());
         bytecode_.push_back(packed_inst);
     }
 }
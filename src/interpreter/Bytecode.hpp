@@ -69,10 +69,41 @@ struct PackedInstruction {
 
 class Bytecode {
 public:
+    /** Compile the script. Throws if the script does not follow
+    the grammar, if a number of commands is out of the range accepted
+    by Changer or if a target of jump is not an instruction of
+    the script, so compiled scripts can be run by TrustedChanger.
+    */
     static BytecodePtr make(const std::string& source);
 
     PackedInstruction getInstruction(int index) const;
 
+    int getInstructionsNumber() const;
+
+    /** Return heap memory used by the bytecode (bytes) */
+    long long getMemoryUsage() const;
+
+    /** Return the number of functions of the language
+    (function IDs are 0 ... number - 1)
+    */
+    static int getFunctionsNumber();
+
+    /** Return the name of the function in scripts */
+    static const char* getFunctionName(int function_id);
+
+    /** Return true if the function accepts the given numbers
+    of parameters and specifications
+    */
+    static bool acceptsArguments(int function_id, int params, int specs);
+
+    /** Return source text of the instruction (without '\n') */
+    static std::string toSource(const PackedInstruction& instruction);
+
+    /** Return numbers of source lines (from 1) of instructions
+    of the script (empty lines are not instructions)
+    */
+    static Ints getSourceLines(const std::string& source);
+
 private:
     PackedInstructions bytecode_;
 
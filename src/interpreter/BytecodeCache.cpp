@@ -0,0 +1,90 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include "BytecodeCache.hpp"
+#include "Metrics.hpp"
+
+namespace Implementation {
+
+typedef std::lock_guard<std::mutex> Lock;
+
+BytecodeCache::BytecodeCache(int max_size)
+    : max_size_(max_size)
+    , hits_(0)
+    , misses_(0)
+{
+}
+
+BytecodePtr BytecodeCache::get(const std::string& source) {
+    {
+        Lock lock(mutex_);
+        BytecodeMap::const_iterator it = bytecode_.find(source);
+        if (it != bytecode_.end()) {
+            hits_++;
+            if (Metrics::isActive()) {
+                Metrics::addCacheLookup(true);
+            }
+            return it->second;
+        }
+    }
+    // compile outside of the lock, may throw
+    BytecodePtr bytecode = Bytecode::make(source);
+    Lock lock(mutex_);
+    if (bytecode_.size() >= max_size_) {
+        removeUnused();
+    }
+    std::pair<BytecodeMap::iterator, bool> inserted =
+        bytecode_.insert(std::make_pair(source, bytecode));
+    if (inserted.second) {
+        misses_++;
+    } else {
+        // other thread has compiled the same script
+        hits_++;
+    }
+    if (Metrics::isActive()) {
+        Metrics::addCacheLookup(!inserted.second);
+    }
+    return inserted.first->second;
+}
+
+BytecodePtrs BytecodeCache::get(const Strings& sources) {
+    BytecodePtrs result;
+    for (int i = 0; i < sources.size(); i++) {
+        result.push_back(get(sources[i]));
+    }
+    return result;
+}
+
+int BytecodeCache::getHits() const {
+    Lock lock(mutex_);
+    return hits_;
+}
+
+int BytecodeCache::getMisses() const {
+    Lock lock(mutex_);
+    return misses_;
+}
+
+int BytecodeCache::size() const {
+    Lock lock(mutex_);
+    return bytecode_.size();
+}
+
+void BytecodeCache::removeUnused() {
+    // other owners get their copies under the mutex,
+    // so a script with one owner can not be taken concurrently
+    BytecodeMap::iterator it = bytecode_.begin();
+    while (it != bytecode_.end()) {
+        if (it->second.use_count() == 1) {
+            it = bytecode_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+}
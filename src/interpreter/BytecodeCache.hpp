@@ -0,0 +1,61 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef BYTECODE_CACHE_HPP_
+#define BYTECODE_CACHE_HPP_
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "CoreGlobals.hpp"
+#include "Bytecode.hpp"
+
+namespace Implementation {
+
+/** Compiled scripts shared between games.
+Bytecode is immutable after compilation, so one instance
+can be used by many games (and threads) at once.
+When the cache is full, scripts which are not used
+by any game are removed before a new script is added.
+*/
+class BytecodeCache {
+public:
+    static const int DEFAULT_MAX_SIZE = 1024;
+
+    explicit BytecodeCache(int max_size = DEFAULT_MAX_SIZE);
+
+    /** Return compiled script (compile it if it is not in the cache).
+    Thread-safe.
+    */
+    BytecodePtr get(const std::string& source);
+
+    /** Return compiled scripts (one per source) */
+    BytecodePtrs get(const Strings& sources);
+
+    int getHits() const;
+
+    int getMisses() const;
+
+    int size() const;
+
+private:
+    typedef std::map<std::string, BytecodePtr> BytecodeMap;
+
+    BytecodeMap bytecode_;
+    int max_size_;
+    int hits_;
+    int misses_;
+    mutable std::mutex mutex_;
+
+    // remove scripts referenced only by the cache (mutex_ is locked)
+    void removeUnused();
+};
+
+}
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "InstructionProfile.hpp"
+#include "Bytecode.hpp"
+#include "Exception.hpp"
+
+namespace Implementation {
+
+InstructionProfile::InstructionProfile() {
+}
+
+void InstructionProfile::resize(const Ints& instructions) {
+    teams_.resize(instructions.size());
+    for (int team = 0; team < instructions.size(); team++) {
+        if (teams_[team].size() != instructions[team]) {
+            Counters zero = {0, 0};
+            teams_[team].assign(instructions[team], zero);
+        }
+    }
+}
+
+void InstructionProfile::clear() {
+    for (int team = 0; team < teams_.size(); team++) {
+        Counters zero = {0, 0};
+        teams_[team].assign(teams_[team].size(), zero);
+    }
+}
+
+int InstructionProfile::getTeamsNumber() const {
+    return teams_.size();
+}
+
+int InstructionProfile::getInstructionsNumber(int team) const {
+    return teams_.at(team).size();
+}
+
+uint64_t InstructionProfile::getDispatches(
+    int team,
+    int instruction
+) const {
+    return teams_.at(team).at(instruction).dispatches;
+}
+
+uint64_t InstructionProfile::getCycles(int team, int instruction) const {
+    return teams_.at(team).at(instruction).cycles;
+}
+
+uint64_t InstructionProfile::now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    std::chrono::nanoseconds time =
+        std::chrono::steady_clock::now().time_since_epoch();
+    return time.count();
+#endif
+}
+
+static double share(uint64_t value, uint64_t total) {
+    return (total == 0) ? 0 : (100.0 * value / total);
+}
+
+void writeProfileReport(
+    std::ostream& out,
+    const InstructionProfile& profile,
+    int team,
+    const std::string& source
+) {
+    Ints lines = Bytecode::getSourceLines(source);
+    int instructions = profile.getInstructionsNumber(team);
+    if (lines.size() != instructions) {
+        throw Exception("Profile: source differs from the bytecode.");
+    }
+    uint64_t total_dispatches = 0;
+    uint64_t total_cycles = 0;
+    for (int i = 0; i < instructions; i++) {
+        total_dispatches += profile.getDispatches(team, i);
+        total_cycles += profile.getCycles(team, i);
+    }
+    out << "team " << team << ": dispatches " << total_dispatches
+        << ", cycles " << total_cycles << std::endl;
+    out << " line  dispatches   share        cycles   share  source"
+        << std::endl;
+    std::istringstream source_stream(source);
+    std::string text;
+    int instruction = 0;
+    char row[128];
+    for (int line = 1; std::getline(source_stream, text); line++) {
+        if ((instruction < instructions) && (lines[instruction] == line)) {
+            uint64_t dispatches = profile.getDispatches(team, instruction);
+            uint64_t cycles = profile.getCycles(team, instruction);
+            snprintf(
+                row,
+                sizeof(row),
+                "%5d %11llu %6.1f%% %13llu %6.1f%%  ",
+                line,
+                (unsigned long long) dispatches,
+                share(dispatches, total_dispatches),
+                (unsigned long long) cycles,
+                share(cycles, total_cycles)
+            );
+            instruction++;
+        } else {
+            snprintf(row, sizeof(row), "%5d %43s", line, "");
+        }
+        out << row << text << std::endl;
+    }
+}
+
+}
@@ -0,0 +1,77 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef INSTRUCTION_PROFILE_HPP_
+#define INSTRUCTION_PROFILE_HPP_
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "CoreGlobals.hpp"
+
+namespace Implementation {
+
+/** Dispatch counts and cycles of every instruction of every team.
+
+Filled by Interpreter if the profile is set (Game::setProfile()).
+Cycles are ticks of the time stamp counter (nanoseconds on
+processors without it) spent in commands of the instruction.
+*/
+class InstructionProfile {
+public:
+    InstructionProfile();
+
+    /** Set number of instructions of every team,
+    counters of teams which sizes are not changed are kept
+    */
+    void resize(const Ints& instructions);
+
+    /** Set all counters to 0 */
+    void clear();
+
+    void add(int team, int instruction, uint64_t cycles) {
+        Counters& counters = teams_[team][instruction];
+        counters.dispatches++;
+        counters.cycles += cycles;
+    }
+
+    int getTeamsNumber() const;
+
+    int getInstructionsNumber(int team) const;
+
+    uint64_t getDispatches(int team, int instruction) const;
+
+    uint64_t getCycles(int team, int instruction) const;
+
+    /** Return current value of the cycle counter */
+    static uint64_t now();
+
+private:
+    struct Counters {
+        uint64_t dispatches;
+        uint64_t cycles;
+    };
+
+    std::vector<std::vector<Counters> > teams_;
+};
+
+/** Write the heatmap of the team: every line of the script with
+dispatches and cycles of its instruction and their shares
+\param source Script of the team passed to Interpreter::makeBytecode
+*/
+void writeProfileReport(
+    std::ostream& out,
+    const InstructionProfile& profile,
+    int team,
+    const std::string& source
+);
+
+}
+
+#endif
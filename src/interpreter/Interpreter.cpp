@@ -6,6 +6,8 @@
  */
 
 #include "Interpreter.hpp"
+#include "Counters.hpp"
+#include "Trace.hpp"
 
 namespace Abstract {
 
@@ -16,6 +18,10 @@ void Interpreter::makeBytecode(const Strings& scripts) {
     return makeBytecode_impl(scripts);
 }
 
+void Interpreter::setBytecode(const BytecodePtrs& bytecode) {
+    return setBytecode_impl(bytecode);
+}
+
 void Interpreter::makeMove(Changer& changer, State* st) const {
     return makeMove_impl(changer, st);
 }
@@ -24,33 +30,68 @@ State* Interpreter::createState() const {
     return createState_impl();
 }
 
+int Interpreter::getInstructionsNumber(int team) const {
+    return getInstructionsNumber_impl(team);
+}
+
+long long Interpreter::getBytecodeMemory() const {
+    return getBytecodeMemory_impl();
+}
+
+void Interpreter::setProfile(
+    Implementation::InstructionProfile* profile
+) {
+    return setProfile_impl(profile);
+}
+
 }
 
 namespace Implementation {
 
+Interpreter::Interpreter()
+    : profile_(NULL) {
+}
+
 void Interpreter::makeBytecode_impl(const Strings& scripts) {
     for (int i = 0; i < scripts.size(); i++) {
         BytecodePtr bytecode_ptr = Bytecode::make(scripts[i]);
         bytecode_.push_back(bytecode_ptr);
     }
+    resizeProfile();
+}
+
+void Interpreter::setBytecode_impl(const BytecodePtrs& bytecode) {
+    bytecode_ = bytecode;
+    resizeProfile();
 }
 
 void Interpreter::makeMove_impl(
     Abstract::Changer& changer,
     Abstract::State* st
 ) const {
+    COUNTER_TEAM_MOVE();
+    int team = changer.getTeam();
+    TRACE_SCOPE("team move", team);
     changer.clearBeforeMove();
     int bacteria = changer.getBacteriaNumber();
-    int team = changer.getTeam();
     for (int b = 0; b < bacteria; b++) {
+        TRACE_SCOPE("bacterium", b);
         while (!changer.endOfMove(b)) {
             int instruction_number = changer.getInstruction(b);
             PackedInstruction pi =
                 bytecode_[team]->getInstruction(instruction_number);
             int func_id = pi.function_id;
+            COUNTER_INC(Counters::COMMAND_EAT + func_id);
             Abstract::Params params(pi.p1, pi.p2, pi.spec);
             ChangerMethod func = changer_functions[func_id];
-            (changer.*func)(&params, b);
+            if (profile_ == NULL) {
+                (changer.*func)(&params, b);
+            } else {
+                uint64_t start = InstructionProfile::now();
+                (changer.*func)(&params, b);
+                uint64_t cycles = InstructionProfile::now() - start;
+                profile_->add(team, instruction_number, cycles);
+            }
         }
     }
 }
@@ -58,4 +99,31 @@ void Interpreter::makeMove_impl(
 Abstract::State* Interpreter::createState_impl() const {
 }
 
+int Interpreter::getInstructionsNumber_impl(int team) const {
+    return bytecode_[team]->getInstructionsNumber();
+}
+
+long long Interpreter::getBytecodeMemory_impl() const {
+    long long memory = bytecode_.capacity() * sizeof(BytecodePtr);
+    for (int team = 0; team < bytecode_.size(); team++) {
+        memory += bytecode_[team]->getMemoryUsage();
+    }
+    return memory;
+}
+
+void Interpreter::setProfile_impl(InstructionProfile* profile) {
+    profile_ = profile;
+    resizeProfile();
+}
+
+void Interpreter::resizeProfile() {
+    if (profile_ != NULL) {
+        Ints instructions;
+        for (int team = 0; team < bytecode_.size(); team++) {
+            instructions.push_back(getInstructionsNumber_impl(team));
+        }
+        profile_->resize(instructions);
+    }
+}
+
 }
@@ -16,6 +16,7 @@
 #include "Bytecode.hpp"
 #include "State.hpp"
 #include "Changer.hpp"
+#include "InstructionProfile.hpp"
 
 namespace Abstract {
 
@@ -25,16 +26,39 @@ public:
 
     void makeBytecode(const Strings& scripts);
 
+    // use already compiled scripts (one per team)
+    void setBytecode(const BytecodePtrs& bytecode);
+
     void makeMove(Changer& changer, State* st) const;
 
     State* createState() const;
 
+    int getInstructionsNumber(int team) const;
+
+    // heap memory used by bytecode of all teams (bytes)
+    long long getBytecodeMemory() const;
+
+    /** Count dispatches and cycles of instructions in the profile
+    (sized for the bytecode); NULL disables profiling
+    */
+    void setProfile(Implementation::InstructionProfile* profile);
+
 protected:
     virtual void makeBytecode_impl(const Strings& scripts) = 0;
 
+    virtual void setBytecode_impl(const BytecodePtrs& bytecode) = 0;
+
     virtual void makeMove_impl(Changer& changer, State* st) const = 0;
 
+    virtual int getInstructionsNumber_impl(int team) const = 0;
+
+    virtual long long getBytecodeMemory_impl() const = 0;
+
     virtual State* createState_impl() const = 0;
+
+    virtual void setProfile_impl(
+        Implementation::InstructionProfile* profile
+    ) = 0;
 };
 
 }
@@ -62,9 +86,14 @@ static const ChangerMethod changer_functions[] = {
 };
 
 class Interpreter : public Abstract::Interpreter {
+public:
+    Interpreter();
+
 protected:
     void makeBytecode_impl(const Strings& scripts);
 
+    void setBytecode_impl(const BytecodePtrs& bytecode);
+
     void makeMove_impl(
         Abstract::Changer& changer,
         Abstract::State* st
@@ -72,8 +101,17 @@ protected:
 
     Abstract::State* createState_impl() const;
 
+    int getInstructionsNumber_impl(int team) const;
+
+    long long getBytecodeMemory_impl() const;
+
+    void setProfile_impl(InstructionProfile* profile);
+
 private:
     BytecodePtrs bytecode_;
+    InstructionProfile* profile_;
+
+    void resizeProfile();
 };
 
 }
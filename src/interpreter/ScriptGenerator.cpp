@@ -0,0 +1,278 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <cstring>
+
+#include "ScriptGenerator.hpp"
+
+namespace Implementation {
+
+// maximum mass in conditions of jg and jl
+static const int MAX_MASS_THRESHOLD = 100;
+
+// forms of instructions: (parameters, specifications)
+static const int FORMS_NUMBER = 4;
+static const int FORMS[FORMS_NUMBER][2] = {{0, 0}, {1, 0}, {2, 0}, {0, 1}};
+
+// Return the number of the parameter which is a target of jump
+// (1 for j and je, 2 for jg and jl) or 0 if there is no target.
+static int targetParameter(int function_id) {
+    const char* name = Bytecode::getFunctionName(function_id);
+    if ((std::strcmp(name, "j") == 0) || (std::strcmp(name, "je") == 0)) {
+        return 1;
+    }
+    if ((std::strcmp(name, "jg") == 0) || (std::strcmp(name, "jl") == 0)) {
+        return 2;
+    }
+    return 0;
+}
+
+// jumps always have their targets (the grammar has only one form
+// of them), so a target may be temporarily negative
+static int* getTarget(PackedInstruction& instruction) {
+    int target = targetParameter(instruction.function_id);
+    if (target == 1) {
+        return &instruction.p1;
+    } else if (target == 2) {
+        return &instruction.p2;
+    }
+    return NULL;
+}
+
+// targets out of the script are wrapped around
+static void fixTargets(PackedInstructions& script) {
+    int length = script.size();
+    for (int i = 0; i < length; i++) {
+        int* target = getTarget(script[i]);
+        if (target != NULL) {
+            *target = ((*target % length) + length) % length;
+        }
+    }
+}
+
+ScriptMix::ScriptMix(int actions, int pseudo_actions, int jumps)
+    : actions(actions)
+    , pseudo_actions(pseudo_actions)
+    , jumps(jumps) {
+}
+
+ScriptGenerator::ScriptGenerator(
+    unsigned int seed,
+    int max_length,
+    const ScriptMix& mix
+)
+    : random_(seed)
+    , max_length_(max_length)
+    , total_weight_(0) {
+    if (max_length < 1) {
+        throw Exception("ScriptGenerator: invalid maximum length.");
+    }
+    if ((mix.actions < 0) || (mix.pseudo_actions < 0) || (mix.jumps < 0)) {
+        throw Exception("ScriptGenerator: negative weight of functions.");
+    }
+    for (int i = 0; i < Bytecode::getFunctionsNumber(); i++) {
+        int weight = mix.pseudo_actions;
+        if (isAction(i)) {
+            weight = mix.actions;
+        } else if (isJump(i)) {
+            weight = mix.jumps;
+        }
+        weights_.push_back(weight);
+        total_weight_ += weight;
+    }
+    if (total_weight_ == 0) {
+        throw Exception("ScriptGenerator: all weights of functions are 0.");
+    }
+}
+
+// with equal weights the function is random_.next(functions number)
+int ScriptGenerator::makeFunction() {
+    int value = random_.next(total_weight_);
+    int function_id = 0;
+    while (value >= weights_[function_id]) {
+        value -= weights_[function_id];
+        function_id++;
+    }
+    return function_id;
+}
+
+PackedInstruction ScriptGenerator::makeInstruction(int length) {
+    int function_id = makeFunction();
+    int forms[FORMS_NUMBER];
+    int forms_number = 0;
+    for (int i = 0; i < FORMS_NUMBER; i++) {
+        int params = FORMS[i][0];
+        int specs = FORMS[i][1];
+        if (Bytecode::acceptsArguments(function_id, params, specs)) {
+            forms[forms_number] = i;
+            forms_number++;
+        }
+    }
+    // every function of the language has at least one form
+    const int* form = FORMS[forms[random_.next(forms_number)]];
+    PackedInstruction instruction(
+        function_id,
+        (form[0] >= 1) ? 0 : -1,
+        (form[0] == 2) ? 0 : -1,
+        form[1] == 1
+    );
+    makeArguments(instruction, length);
+    return instruction;
+}
+
+PackedInstructions ScriptGenerator::makeScript(int length) {
+    PackedInstructions script;
+    for (int i = 0; i < length; i++) {
+        script.push_back(makeInstruction(length));
+    }
+    return script;
+}
+
+static void checkNotEmpty(const PackedInstructions& script) {
+    if (script.empty()) {
+        throw Exception("ScriptGenerator: empty script.");
+    }
+}
+
+void ScriptGenerator::mutate(PackedInstructions& script) {
+    checkNotEmpty(script);
+    int length = script.size();
+    int kind = random_.next(4);
+    int index = random_.next(length);
+    if ((kind == 0) && (script[index].p1 != -1)) {
+        makeArguments(script[index], length);
+    } else if ((kind == 2) && (length < max_length_)) {
+        int place = random_.next(length + 1);
+        insertInstruction(script, place, makeInstruction(length + 1));
+    } else if ((kind == 3) && (length > 1)) {
+        removeInstruction(script, index);
+    } else {
+        script[index] = makeInstruction(length);
+    }
+}
+
+PackedInstructions ScriptGenerator::crossover(
+    const PackedInstructions& first,
+    const PackedInstructions& second
+) {
+    checkNotEmpty(first);
+    checkNotEmpty(second);
+    int first_end = random_.next(first.size() + 1);
+    int second_begin = random_.next(second.size());
+    PackedInstructions child(first.begin(), first.begin() + first_end);
+    for (int i = second_begin; i < second.size(); i++) {
+        PackedInstruction instruction = second[i];
+        // jumps of the second part keep relative targets
+        int* target = getTarget(instruction);
+        if (target != NULL) {
+            *target += first_end - second_begin;
+        }
+        child.push_back(instruction);
+    }
+    if (child.size() > max_length_) {
+        child.resize(max_length_, child[0]);
+    }
+    fixTargets(child);
+    return child;
+}
+
+int ScriptGenerator::random(int end) {
+    return random_.next(end);
+}
+
+int ScriptGenerator::getMaxLength() const {
+    return max_length_;
+}
+
+bool ScriptGenerator::isAction(int function_id) {
+    const char* name = Bytecode::getFunctionName(function_id);
+    return (std::strcmp(name, "eat") == 0) ||
+           (std::strcmp(name, "go") == 0) ||
+           (std::strcmp(name, "clon") == 0) ||
+           (std::strcmp(name, "str") == 0);
+}
+
+bool ScriptGenerator::isJump(int function_id) {
+    return targetParameter(function_id) != 0;
+}
+
+PackedInstructions ScriptGenerator::fromBytecode(const Bytecode& bytecode) {
+    PackedInstructions script;
+    for (int i = 0; i < bytecode.getInstructionsNumber(); i++) {
+        script.push_back(bytecode.getInstruction(i));
+    }
+    return script;
+}
+
+std::string ScriptGenerator::toSource(const PackedInstructions& script) {
+    std::string source;
+    for (int i = 0; i < script.size(); i++) {
+        source += Bytecode::toSource(script[i]);
+        source += '\n';
+    }
+    return source;
+}
+
+void ScriptGenerator::makeArguments(
+    PackedInstruction& instruction,
+    int length
+) {
+    int target = targetParameter(instruction.function_id);
+    // numbers of commands accepted by Changer
+    int commands_begin = MIN_COMMANDS_PER_INSTRUCTION + 1;
+    int commands_range = MAX_COMMANDS_PER_INSTRUCTION - commands_begin;
+    if (instruction.p1 != -1) {
+        if (target == 1) {
+            instruction.p1 = random_.next(length);
+        } else if (target == 2) {
+            instruction.p1 = random_.next(MAX_MASS_THRESHOLD + 1);
+        } else {
+            instruction.p1 = commands_begin + random_.next(commands_range);
+        }
+    }
+    if (instruction.p2 != -1) {
+        if (target == 2) {
+            instruction.p2 = random_.next(length);
+        } else {
+            instruction.p2 = commands_begin + random_.next(commands_range);
+        }
+    }
+}
+
+void ScriptGenerator::insertInstruction(
+    PackedInstructions& script,
+    int index,
+    const PackedInstruction& instruction
+) {
+    for (int i = 0; i < script.size(); i++) {
+        int* target = getTarget(script[i]);
+        if ((target != NULL) && (*target >= index)) {
+            (*target)++;
+        }
+    }
+    script.insert(script.begin() + index, instruction);
+}
+
+void ScriptGenerator::removeInstruction(
+    PackedInstructions& script,
+    int index
+) {
+    script.erase(script.begin() + index);
+    int length = script.size();
+    for (int i = 0; i < length; i++) {
+        int* target = getTarget(script[i]);
+        if ((target != NULL) && (*target > index)) {
+            (*target)--;
+        }
+        // jump to the removed last instruction goes to the first one
+        if ((target != NULL) && (*target == length)) {
+            *target = 0;
+        }
+    }
+}
+
+}
@@ -0,0 +1,113 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef SCRIPT_GENERATOR_HPP_
+#define SCRIPT_GENERATOR_HPP_
+
+#include <string>
+
+#include "CoreGlobals.hpp"
+#include "CoreConstants.hpp"
+#include "Bytecode.hpp"
+#include "random.hpp"
+
+namespace Implementation {
+
+static const int DEFAULT_MAX_SCRIPT_LENGTH = 32;
+
+/** Weights of kinds of functions in generated scripts.
+Every function of a kind has the weight of the kind, so
+ScriptMix(2, 1, 0) produces actions (eat, go, clon, str) twice
+as often as pseudo actions (left, right, back, turn) and no jumps.
+*/
+struct ScriptMix {
+    ScriptMix(int actions = 1, int pseudo_actions = 1, int jumps = 1);
+
+    int actions;
+    int pseudo_actions;
+    int jumps;
+};
+
+/** Random scripts and their variations on the level of instructions.
+
+Every produced script is valid: functions and their arguments follow
+the grammar of Bytecode, numbers of commands are in the range accepted
+by Changer and targets of jumps are instructions of the script.
+Results depend only on the seed and the sequence of calls.
+*/
+class ScriptGenerator {
+public:
+    /** Constructor
+    \param seed Seed of random generator
+    \param max_length Maximum number of instructions of a script
+    \param mix Weights of functions of new instructions
+    */
+    ScriptGenerator(
+        unsigned int seed,
+        int max_length = DEFAULT_MAX_SCRIPT_LENGTH,
+        const ScriptMix& mix = ScriptMix()
+    );
+
+    /** Return random instruction of a script of the given length */
+    PackedInstruction makeInstruction(int length);
+
+    /** Return random script of the given length */
+    PackedInstructions makeScript(int length);
+
+    /** Apply one random change: new arguments of an instruction,
+    new instruction, insertion or removal of an instruction
+    */
+    void mutate(PackedInstructions& script);
+
+    /** Return the beginning of the first script followed by
+    the end of the second one (both points are random)
+    */
+    PackedInstructions crossover(
+        const PackedInstructions& first,
+        const PackedInstructions& second
+    );
+
+    /** Return random number from interval [0, end) */
+    int random(int end);
+
+    int getMaxLength() const;
+
+    /** Return true if the function is an action (eat, go, clon, str) */
+    static bool isAction(int function_id);
+
+    /** Return true if the function is a jump */
+    static bool isJump(int function_id);
+
+    /** Return instructions of the compiled script */
+    static PackedInstructions fromBytecode(const Bytecode& bytecode);
+
+    /** Return source of the script */
+    static std::string toSource(const PackedInstructions& script);
+
+private:
+    Random random_;
+    int max_length_;
+    // weight of every function (see ScriptMix)
+    Ints weights_;
+    int total_weight_;
+
+    int makeFunction();
+
+    void makeArguments(PackedInstruction& instruction, int length);
+
+    static void insertInstruction(
+        PackedInstructions& script,
+        int index,
+        const PackedInstruction& instruction
+    );
+
+    static void removeInstruction(PackedInstructions& script, int index);
+};
+
+}
+
+#endif
@@ -6,6 +6,9 @@
  */
 
 #include "Changer.hpp"
+#include "BinaryStream.hpp"
+#include "Counters.hpp"
+#include "Trace.hpp"
 
 namespace Abstract {
 
@@ -40,6 +43,14 @@ int Changer::getInstruction(int bacterium_index) const {
     return getInstruction_impl(bacterium_index);
 }
 
+Ints Changer::getCompletedCommands() const {
+    return getCompletedCommands_impl();
+}
+
+long long Changer::getMemoryUsage() const {
+    return getMemoryUsage_impl();
+}
+
 void Changer::eat(const Params* params, int bacterium_index) {
     return eat_impl(params, bacterium_index);
 }
@@ -88,6 +99,14 @@ void Changer::je(const Params* params, int bacterium_index) {
     return je_impl(params, bacterium_index);
 }
 
+std::string Changer::snapshot() const {
+    return snapshot_impl();
+}
+
+void Changer::restore(const std::string& image) {
+    return restore_impl(image);
+}
+
 Changer::Changer(
     ModelPtr /*model*/,
     int /*team*/,
@@ -125,40 +144,13 @@ bool LogicalChanger::roundEnemySearch(
     int bacterium_index,
     Abstract::Point* enemy
 ) const {
+    COUNTER_INC(Counters::ROUND_ENEMY_SEARCHES);
     int direction = model_->getDirection(team_, bacterium_index);
-    Abstract::Point start = model_->getCoordinates(
+    Abstract::Point center = model_->getCoordinates(
         team_,
         bacterium_index
     );
-    // clockwise round magic
-    int delta = 0;
-    Abstract::Point center = start;
-    for (int i = 0; i < 6; i++) {
-        int steps;
-        if ((i < 2) || (i == 5)) {
-            steps = 1;
-        } else {
-            steps = 2;
-        }
-        Abstract::Point temp = start;
-        bool found = nextCoordinates(
-            direction,
-            steps - delta,
-            start,
-            enemy
-        );
-        bool error = (std::abs((start.x - center.x)) > 1) ||
-                     (std::abs((start.y - center.y)) > 1);
-        delta = ((error) ? 1 : 0);
-        direction = ((error) ? direction : toRight(direction));
-        if (error) {
-            i--;
-            start = temp;
-        } else if (found) {
-            return true;
-        }
-    }
-    return false;
+    return model_->roundEnemySearch(center, direction, team_, enemy);
 }
 
 void LogicalChanger::eat(int bacterium_index) {
@@ -169,6 +161,7 @@ void LogicalChanger::go(int bacterium_index) {
     model_->changeMass(team_, bacterium_index, GO_MASS);
     int mass = model_->getMass(team_, bacterium_index);
     if (mass <= 0) {
+        COUNTER_INC(Counters::DEATHS_GO);
         model_->kill(team_, bacterium_index);
     } else {
         Abstract::Point coordinates = model_->getCoordinates(
@@ -176,7 +169,7 @@ void LogicalChanger::go(int bacterium_index) {
             bacterium_index
         );
         int direction = model_->getDirection(team_, bacterium_index);
-        nextCoordinates(direction, 1, coordinates);
+        coordinates = model_->getNeighbour(coordinates, direction);
         Abstract::CellState state = model_->cellState(coordinates);
         if (state == Abstract::EMPTY) {
             model_->setCoordinates(team_, bacterium_index, coordinates);
@@ -188,9 +181,11 @@ void LogicalChanger::clon(int bacterium_index) {
     model_->changeMass(team_, bacterium_index, CLON_MASS);
     int mass = model_->getMass(team_, bacterium_index);
     if (mass < 0) {
+        COUNTER_INC(Counters::DEATHS_CLON);
         model_->kill(team_, bacterium_index);
     } else if (mass == 0) {
         clonLogic(bacterium_index);
+        COUNTER_INC(Counters::DEATHS_CLON);
         model_->kill(team_, bacterium_index);
     } else {
         clonLogic(bacterium_index);
@@ -201,9 +196,11 @@ void LogicalChanger::str(int bacterium_index) {
     model_->changeMass(team_, bacterium_index, STR_MASS);
     int mass = model_->getMass(team_, bacterium_index);
     if (mass < 0) {
+        COUNTER_INC(Counters::DEATHS_STR);
         model_->kill(team_, bacterium_index);
     } else if (mass == 0) {
         strLogic(bacterium_index);
+        COUNTER_INC(Counters::DEATHS_STR);
         model_->kill(team_, bacterium_index);
     } else {
         strLogic(bacterium_index);
@@ -229,7 +226,29 @@ void LogicalChanger::back(int bacterium_index) {
 }
 
 void LogicalChanger::turn(int bacterium_index) {
-    int direction = random(4);
+    int direction = model_->random(4);
+    model_->setDirection(team_, bacterium_index, direction);
+}
+
+void LogicalChanger::eat(int bacterium_index, int times) {
+    model_->changeMass(team_, bacterium_index, EAT_MASS * times);
+}
+
+void LogicalChanger::left(int bacterium_index, int times) {
+    int direction = model_->getDirection(team_, bacterium_index);
+    direction = (direction + 4 - times % 4) % 4;
+    model_->setDirection(team_, bacterium_index, direction);
+}
+
+void LogicalChanger::right(int bacterium_index, int times) {
+    int direction = model_->getDirection(team_, bacterium_index);
+    direction = (direction + times) % 4;
+    model_->setDirection(team_, bacterium_index, direction);
+}
+
+void LogicalChanger::back(int bacterium_index, int times) {
+    int direction = model_->getDirection(team_, bacterium_index);
+    direction = (direction + 2 * (times % 2)) % 4;
     model_->setDirection(team_, bacterium_index, direction);
 }
 
@@ -240,7 +259,7 @@ void LogicalChanger::clonLogic(int bacterium_index) {
         bacterium_index
     );
     Abstract::Point temp = coordinates;
-    nextCoordinates(direction, 1, coordinates);
+    coordinates = model_->getNeighbour(coordinates, direction);
     Abstract::CellState state = model_->cellState(coordinates);
     bool equal = ((temp.x == coordinates.x) &&
                   (temp.y == coordinates.y));
@@ -248,7 +267,7 @@ void LogicalChanger::clonLogic(int bacterium_index) {
         model_->createNewByCoordinates(
             coordinates,
             DEFAULT_CLON_MASS,
-            random(4),
+            model_->random(4),
             team_,
             0
         );
@@ -259,68 +278,36 @@ void LogicalChanger::clonLogic(int bacterium_index) {
 
 void LogicalChanger::strLogic(int bacterium_index) {
     int mass = model_->getMass(team_, bacterium_index);
-    int damage = random(-MAX_STR_DAMAGE) + mass / 2;
+    int damage = model_->random(-MAX_STR_DAMAGE) + mass / 2;
     Abstract::Point enemy;
     bool has_enemy = roundEnemySearch(bacterium_index, &enemy);
     if (has_enemy) {
         model_->changeMassByCoordinates(enemy, -damage);
         int enemy_mass = model_->getMassByCoordinates(enemy);
         if (enemy_mass <= 0) {
+            COUNTER_INC(Counters::DEATHS_ATTACKED);
             model_->killByCoordinates(enemy);
         }
     }
 }
 
-bool LogicalChanger::nextCoordinates(
-    int direction,
-    int steps,
-    Abstract::Point& start,
-    Abstract::Point* enemy
-) const {
-    int max_width = model_->getWidth() - 1;
-    int max_height = model_->getHeight() - 1;
-    bool found = false;
-    for (int i = 0; i < steps; i++) {
-        if ((direction == Abstract::LEFT) &&
-            (start.x > 0)) {
-            start.x--;
-        } else if ((direction == Abstract::RIGHT) &&
-                   (start.x < max_width)) {
-            start.x++;
-        } else if ((direction == Abstract::BACKWARD) &&
-                   (start.y > 0)) {
-            start.y--;
-        } else if ((direction == Abstract::FORWARD) &&
-                   (start.y < max_height)) {
-            start.y++;
-        }
-        Abstract::CellState state = model_->cellState(start);
-        bool needed = (enemy != NULL) && !found;
-        if (needed && (state == Abstract::BACTERIUM)) {
-            int team = model_->getTeamByCoordinates(start);
-            if (team != team_) {
-                *enemy = start;
-                found = true;
-            }
-        }
-    }
-    return found;
-}
-
 RepeaterParams::RepeaterParams(
     int bacterium_index,
     int commands,
     Ints& remaining_commands_vect,
-    LogicalMethod logic_function
+    LogicalMethod logic_function,
+    LogicalBulkMethod bulk_function
 )
     : bacterium_index(bacterium_index)
     , commands(commands)
     , remaining_commands_vect(remaining_commands_vect)
     , logic_function(logic_function)
+    , bulk_function(bulk_function)
 {
 }
 
-Changer::Changer(
+template<typename Policy>
+BasicChanger<Policy>::BasicChanger(
     ModelPtr model,
     int team,
     int move_number,
@@ -332,13 +319,17 @@ Changer::Changer(
     , move_number_(move_number)
     , instructions_(instructions)
     , logical_changer_(model_, team_, move_number_) {
-    int bacteria = model_->getBacteriaNumber(team_);
+    TRACE_SCOPE("Changer construction", team);
+    // a restored model may keep places of dead bacteria
+    int bacteria = model_->getListSize(team_);
     remaining_actions_.resize(bacteria, MAX_ACTIONS);
     remaining_pseudo_actions_.resize(bacteria, MAX_PSEUDO_ACTIONS);
     completed_commands_.resize(bacteria, 0);
 }
 
-void Changer::clearBeforeMove_impl() {
+template<typename Policy>
+void BasicChanger<Policy>::clearBeforeMove_impl() {
+    TRACE_SCOPE("clearBeforeMove", team_);
     markDead();
     // remove dead
     eraseElements(remaining_actions_, -1);
@@ -358,32 +349,50 @@ void Changer::clearBeforeMove_impl() {
     }
 }
 
-bool Changer::endOfMove_impl(int bacterium_index) const {
+template<typename Policy>
+bool BasicChanger<Policy>::endOfMove_impl(int bacterium_index) const {
     bool actions = remaining_actions_[bacterium_index] > 0;
     bool pseudo_actions = remaining_pseudo_actions_[bacterium_index] > 0;
     bool alive = model_->isAlive(team_, bacterium_index);
     return !(actions && pseudo_actions && alive);
 }
 
-int Changer::getBacteriaNumber_impl() const {
+template<typename Policy>
+int BasicChanger<Policy>::getBacteriaNumber_impl() const {
     return model_->getBacteriaNumber(team_);
 }
 
-int Changer::getTeam_impl() const {
+template<typename Policy>
+int BasicChanger<Policy>::getTeam_impl() const {
     return team_;
 }
 
-int Changer::getInstruction_impl(int bacterium_index) const {
+template<typename Policy>
+int BasicChanger<Policy>::getInstruction_impl(int bacterium_index) const {
     return model_->getInstruction(team_, bacterium_index);
 }
 
-void Changer::eat_impl(
+template<typename Policy>
+Ints BasicChanger<Policy>::getCompletedCommands_impl() const {
+    return completed_commands_;
+}
+
+template<typename Policy>
+long long BasicChanger<Policy>::getMemoryUsage_impl() const {
+    int capacity = remaining_actions_.capacity() +
+                   remaining_pseudo_actions_.capacity() +
+                   completed_commands_.capacity();
+    return capacity * sizeof(int);
+}
+
+template<typename Policy>
+void BasicChanger<Policy>::eat_impl(
     const Abstract::Params* params,
     int bacterium_index
 ) {
     int n = 1;
     if (params->spec) {
-        n = random(RANDOM_MAX_ACTIONS);
+        n = model_->random(RANDOM_MAX_ACTIONS);
     } else if (params->p1 != -1) {
         n = checkCommandsNumber(params->p1);
     }
@@ -391,18 +400,20 @@ void Changer::eat_impl(
         bacterium_index,
         n,
         remaining_actions_,
+        &LogicalChanger::eat,
         &LogicalChanger::eat
     );
     repeater(&rp);
 }
 
-void Changer::go_impl(
+template<typename Policy>
+void BasicChanger<Policy>::go_impl(
     const Abstract::Params* params,
     int bacterium_index
 ) {
     int n = 1;
     if (params->spec) {
-        n = random(RANDOM_MAX_ACTIONS);
+        n = model_->random(RANDOM_MAX_ACTIONS);
     } else if (params->p1 != -1) {
         n = checkCommandsNumber(params->p1);
     }
@@ -415,7 +426,8 @@ void Changer::go_impl(
     repeater(&rp);
 }
 
-void Changer::clon_impl(
+template<typename Policy>
+void BasicChanger<Policy>::clon_impl(
     const Abstract::Params* params,
     int bacterium_index
 ) {
@@ -429,7 +441,8 @@ void Changer::clon_impl(
     repeater(&rp);
 }
 
-void Changer::str_impl(
+template<typename Policy>
+void BasicChanger<Policy>::str_impl(
     const Abstract::Params* params,
     int bacterium_index
 ) {
@@ -446,7 +459,8 @@ void Changer::str_impl(
     repeater(&rp);
 }
 
-void Changer::left_impl(
+template<typename Policy>
+void BasicChanger<Policy>::left_impl(
     const Abstract::Params* params,
     int bacterium_index
 ) {
@@ -458,13 +472,15 @@ void Changer::left_impl(
         bacterium_index,
         n,
         remaining_pseudo_actions_,
+        &LogicalChanger::left,
         &LogicalChanger::left
     );
     repeater(&rp);
     penalize(bacterium_index);
 }
 
-void Changer::right_impl(
+template<typename Policy>
+void BasicChanger<Policy>::right_impl(
     const Abstract::Params* params,
     int bacterium_index
 ) {
@@ -476,13 +492,15 @@ void Changer::right_impl(
         bacterium_index,
         n,
         remaining_pseudo_actions_,
+        &LogicalChanger::right,
         &LogicalChanger::right
     );
     repeater(&rp);
     penalize(bacterium_index);
 }
 
-void Changer::back_impl(
+template<typename Policy>
+void BasicChanger<Policy>::back_impl(
     const Abstract::Params* params,
     int bacterium_index
 ) {
@@ -491,13 +509,15 @@ void Changer::back_impl(
         bacterium_index,
         n,
         remaining_pseudo_actions_,
+        &LogicalChanger::back,
         &LogicalChanger::back
     );
     repeater(&rp);
     penalize(bacterium_index);
 }
 
-void Changer::turn_impl(
+template<typename Policy>
+void BasicChanger<Policy>::turn_impl(
     const Abstract::Params* params,
     int bacterium_index
 ) {
@@ -512,18 +532,16 @@ void Changer::turn_impl(
     penalize(bacterium_index);
 }
 
-void Changer::jg_impl(
+template<typename Policy>
+void BasicChanger<Policy>::jg_impl(
     const Abstract::Params* params,
     int bacterium_index
 ) {
     int mass = model_->getMass(team_, bacterium_index);
     if (mass > params->p1) {
         int instruction = params->p2;
-        if ((instruction >= 0) && instruction < instructions_) {
-            model_->setInstruction(team_, bacterium_index, instruction);
-        } else {
-            throw Exception("Invalid instruction in jg command.");
-        }
+        checkInstruction(instruction, "jg");
+        model_->setInstruction(team_, bacterium_index, instruction);
     } else {
         updateInstruction(bacterium_index);
     }
@@ -534,18 +552,16 @@ void Changer::jg_impl(
     penalize(bacterium_index);
 }
 
-void Changer::jl_impl(
+template<typename Policy>
+void BasicChanger<Policy>::jl_impl(
     const Abstract::Params* params,
     int bacterium_index
 ) {
     int mass = model_->getMass(team_, bacterium_index);
     if (mass < params->p1) {
         int instruction = params->p2;
-        if ((instruction >= 0) && instruction < instructions_) {
-            model_->setInstruction(team_, bacterium_index, instruction);
-        } else {
-            throw Exception("Invalid instruction in jl command.");
-        }
+        checkInstruction(instruction, "jl");
+        model_->setInstruction(team_, bacterium_index, instruction);
     } else {
         updateInstruction(bacterium_index);
     }
@@ -556,16 +572,14 @@ void Changer::jl_impl(
     penalize(bacterium_index);
 }
 
-void Changer::j_impl(
+template<typename Policy>
+void BasicChanger<Policy>::j_impl(
     const Abstract::Params* params,
     int bacterium_index
 ) {
     int instruction = params->p1;
-    if ((instruction >= 0) && (instruction < instructions_)) {
-        model_->setInstruction(team_, bacterium_index, instruction);
-    } else {
-        throw Exception("Invalid instruction in j command.");
-    }
+    checkInstruction(instruction, "j");
+    model_->setInstruction(team_, bacterium_index, instruction);
     remainingActionsDecrement(
         remaining_pseudo_actions_,
         bacterium_index
@@ -573,7 +587,8 @@ void Changer::j_impl(
     penalize(bacterium_index);
 }
 
-void Changer::je_impl(
+template<typename Policy>
+void BasicChanger<Policy>::je_impl(
     const Abstract::Params* params,
     int bacterium_index
 ) {
@@ -581,11 +596,8 @@ void Changer::je_impl(
     bool enemy = logical_changer_.roundEnemySearch(bacterium_index, &en);
     if (enemy) {
         int instruction = params->p1;
-        if ((instruction >= 0) && instruction < instructions_) {
-            model_->setInstruction(team_, bacterium_index, instruction);
-        } else {
-            throw Exception("Invalid instruction in je command.");
-        }
+        checkInstruction(instruction, "je");
+        model_->setInstruction(team_, bacterium_index, instruction);
     } else {
         updateInstruction(bacterium_index);
     }
@@ -596,7 +608,8 @@ void Changer::je_impl(
     penalize(bacterium_index);
 }
 
-void Changer::markDead() {
+template<typename Policy>
+void BasicChanger<Policy>::markDead() {
     int bacteria = remaining_actions_.size();
     for (int b = 0; b < bacteria; b++) {
         if (!model_->isAlive(team_, b)) {
@@ -607,25 +620,28 @@ void Changer::markDead() {
     }
 }
 
-void Changer::remainingActionsDecrement(
+template<typename Policy>
+void BasicChanger<Policy>::remainingActionsDecrement(
     Ints& actions_vect,
     int bacterium_index
 ) {
     bool less = bacterium_index < 0;
     bool greater = bacterium_index >= actions_vect.size();
-    if (less || greater) {
+    if (Policy::CHECK && (less || greater)) {
         throw Exception("Changer: invalid bacterium index.");
     }
     actions_vect[bacterium_index]--;
-    if (actions_vect[bacterium_index] < 0) {
+    if (Policy::CHECK && (actions_vect[bacterium_index] < 0)) {
         throw Exception("Changer: too many commands for one move.");
     }
 }
 
-void Changer::penalize(int bacterium_index) {
+template<typename Policy>
+void BasicChanger<Policy>::penalize(int bacterium_index) {
     bool alive = model_->isAlive(team_, bacterium_index);
     bool end = endOfMove(bacterium_index);
     if (alive && end) {
+        COUNTER_INC(Counters::PSEUDO_ACTION_PENALTIES);
         model_->changeMass(
             team_,
             bacterium_index,
@@ -633,12 +649,14 @@ void Changer::penalize(int bacterium_index) {
         );
         int mass = model_->getMass(team_, bacterium_index);
         if (mass <= 0) {
+            COUNTER_INC(Counters::DEATHS_PENALTY);
             model_->kill(team_, bacterium_index);
         }
     }
 }
 
-void Changer::updateInstruction(int index) {
+template<typename Policy>
+void BasicChanger<Policy>::updateInstruction(int index) {
     completed_commands_[index] = 0;
     int instruction = model_->getInstruction(team_, index);
     if ((instruction + 1) < instructions_) {
@@ -648,28 +666,49 @@ void Changer::updateInstruction(int index) {
     }
 }
 
-int Changer::checkCommandsNumber(int number) const {
+template<typename Policy>
+int BasicChanger<Policy>::checkCommandsNumber(int number) const {
     bool greater = number > MIN_COMMANDS_PER_INSTRUCTION;
     bool less = number < MAX_COMMANDS_PER_INSTRUCTION;
-    if (greater && less) {
+    if (!Policy::CHECK || (greater && less)) {
         return number;
     } else {
         throw Exception("Changer: invalid commands number.");
     }
 }
 
-void Changer::repeater(RepeaterParams* params) {
+template<typename Policy>
+void BasicChanger<Policy>::checkInstruction(
+    int instruction,
+    const char* command
+) const {
+    bool less = instruction < 0;
+    bool greater = instruction >= instructions_;
+    if (Policy::CHECK && (less || greater)) {
+        throw Exception(
+            "Invalid instruction in " + std::string(command) +
+            " command."
+        );
+    }
+}
+
+template<typename Policy>
+void BasicChanger<Policy>::repeater(RepeaterParams* params) {
     int index = params->bacterium_index;
     int total_commands = params->commands;
-    while (!endOfMove(index) &&
-           (completed_commands_[index] < total_commands)) {
-        remainingActionsDecrement(
-            params->remaining_commands_vect,
-            index
-        );
-        completed_commands_[index]++;
-        LogicalMethod method = params->logic_function;
-        (logical_changer_.*method)(index);
+    if (params->bulk_function != NULL) {
+        bulkRepeater(params);
+    } else {
+        while (!endOfMove(index) &&
+               (completed_commands_[index] < total_commands)) {
+            remainingActionsDecrement(
+                params->remaining_commands_vect,
+                index
+            );
+            completed_commands_[index]++;
+            LogicalMethod method = params->logic_function;
+            (logical_changer_.*method)(index);
+        }
     }
     if (model_->isAlive(team_, index)) {
         if (completed_commands_[index] == (total_commands)) {
@@ -678,4 +717,88 @@ void Changer::repeater(RepeaterParams* params) {
     }
 }
 
+template<typename Policy>
+void BasicChanger<Policy>::bulkRepeater(RepeaterParams* params) {
+    int index = params->bacterium_index;
+    if (endOfMove(index)) {
+        return;
+    }
+    // bulk commands neither kill the bacterium nor spend
+    // the other kind of commands, so the step-by-step loop
+    // would stop only when the budget or the commands end
+    Ints& remaining = params->remaining_commands_vect;
+    int commands = params->commands - completed_commands_[index];
+    int times = std::min(commands, remaining[index]);
+    if (times > 0) {
+        remaining[index] -= times;
+        completed_commands_[index] += times;
+        LogicalBulkMethod method = params->bulk_function;
+        (logical_changer_.*method)(index, times);
+    }
+}
+
+static void writeInts(BinaryWriter& writer, const Ints& ints) {
+    writer.writeInt(ints.size());
+    for (int i = 0; i < ints.size(); i++) {
+        writer.writeInt(ints[i]);
+    }
+}
+
+static void readInts(BinaryReader& reader, Ints& ints, int size) {
+    if (reader.readInt() != size) {
+        throw Exception("Changer: invalid snapshot.");
+    }
+    ints.resize(size);
+    for (int i = 0; i < size; i++) {
+        ints[i] = reader.readInt();
+    }
+}
+
+/* Image: team, then remaining_actions_, remaining_pseudo_actions_
+   and completed_commands_ (size and elements, 32-bit little-endian)
+*/
+template<typename Policy>
+std::string BasicChanger<Policy>::snapshot_impl() const {
+    std::string image;
+    BinaryWriter writer(image);
+    writer.writeInt(team_);
+    writeInts(writer, remaining_actions_);
+    writeInts(writer, remaining_pseudo_actions_);
+    writeInts(writer, completed_commands_);
+    return image;
+}
+
+template<typename Policy>
+void BasicChanger<Policy>::restore_impl(const std::string& image) {
+    BinaryReader reader(image);
+    if (reader.readInt() != team_) {
+        throw Exception("Changer: snapshot of other team.");
+    }
+    int size = reader.readInt();
+    // all vectors have the same size; they cover the bacteria of
+    // the team in the model except clones born during the last move
+    if ((size < 0) || (size > model_->getListSize(team_))) {
+        throw Exception("Changer: invalid snapshot.");
+    }
+    // vectors are replaced only if the whole image is valid
+    Ints remaining_actions(size);
+    for (int i = 0; i < size; i++) {
+        remaining_actions[i] = reader.readInt();
+    }
+    Ints remaining_pseudo_actions;
+    readInts(reader, remaining_pseudo_actions, size);
+    Ints completed_commands;
+    readInts(reader, completed_commands, size);
+    if (!reader.atEnd()) {
+        throw Exception("Changer: invalid snapshot.");
+    }
+    remaining_actions_.swap(remaining_actions);
+    remaining_pseudo_actions_.swap(remaining_pseudo_actions);
+    completed_commands_.swap(completed_commands);
+}
+
+// explicit instantiation of both validation policies
+template class BasicChanger<CheckedPolicy>;
+template class BasicChanger<TrustedPolicy>;
+
 }
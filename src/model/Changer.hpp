@@ -8,14 +8,13 @@
 #ifndef CHANGER_HPP_
 #define CHANGER_HPP_
 
-#include <cmath>
 #include <algorithm>
+#include <string>
 
 #include "CoreConstants.hpp"
 #include "CoreGlobals.hpp"
 #include "Model.hpp"
 #include "Exception.hpp"
-#include "random.hpp"
 
 namespace Abstract {
 
@@ -38,6 +37,13 @@ public:
 
     int getInstruction(int bacterium_index) const;
 
+    // commands of current instructions completed by bacteria
+    // (kept between moves, indices of the start of the move)
+    Ints getCompletedCommands() const;
+
+    // heap memory used by the changer (bytes)
+    long long getMemoryUsage() const;
+
     void eat(const Params* params, int bacterium_index);
 
     void go(const Params* params, int bacterium_index);
@@ -62,6 +68,15 @@ public:
 
     void je(const Params* params, int bacterium_index);
 
+    // binary image of the state kept by the changer between
+    // moves (commands completed by bacteria, see Model::snapshot)
+    std::string snapshot() const;
+
+    // replace the state with the image made by snapshot()
+    // (the model must be restored before); throws if the image
+    // does not match the model, the state is not changed then
+    void restore(const std::string& image);
+
 protected:
     Changer(
         ModelPtr model,
@@ -80,6 +95,10 @@ protected:
 
     virtual int getInstruction_impl(int bacterium_index) const = 0;
 
+    virtual Ints getCompletedCommands_impl() const = 0;
+
+    virtual long long getMemoryUsage_impl() const = 0;
+
     virtual void eat_impl(
         const Params* params,
         int bacterium_index
@@ -139,6 +158,10 @@ protected:
         const Abstract::Params* params,
         int bacterium_index
     ) = 0;
+
+    virtual std::string snapshot_impl() const = 0;
+
+    virtual void restore_impl(const std::string& image) = 0;
 };
 
 }
@@ -174,18 +197,22 @@ public:
 
     void turn(int bacterium_index);
 
+    // closed forms of repeated commands, equal to
+    // calling the one-step method `times` times
+
+    void eat(int bacterium_index, int times);
+
+    void left(int bacterium_index, int times);
+
+    void right(int bacterium_index, int times);
+
+    void back(int bacterium_index, int times);
+
 private:
     ModelPtr model_;
     int team_;
     int move_number_;
 
-    bool nextCoordinates(
-        int direction,
-        int steps,
-        Abstract::Point& start,
-        Abstract::Point* enemy = NULL
-    ) const;
-
     void clonLogic(int bacterium_index);
 
     void strLogic(int bacterium_index);
@@ -193,23 +220,36 @@ private:
 
 typedef void (LogicalChanger::*LogicalMethod) (int bacterium_index);
 
+typedef void (LogicalChanger::*LogicalBulkMethod) (
+    int bacterium_index,
+    int times
+);
+
 struct RepeaterParams {
     RepeaterParams(
         int bacterium_index,
         int commands,
         Ints& remaining_commands_vect,
-        LogicalMethod logic_function
+        LogicalMethod logic_function,
+        LogicalBulkMethod bulk_function = NULL
     );
 
     int bacterium_index;
     int commands;
     Ints& remaining_commands_vect;
     LogicalMethod logic_function;
+    // commands which do not interact with other cells
+    // are applied in one step by this method (if not NULL)
+    LogicalBulkMethod bulk_function;
 };
 
-class Changer : public Abstract::Changer {
+/** Changer with validation policy (see Model.hpp) */
+template<typename TPolicy>
+class BasicChanger : public Abstract::Changer {
 public:
-    Changer(
+    typedef TPolicy Policy;
+
+    BasicChanger(
         ModelPtr model,
         int team,
         int move_number,
@@ -227,6 +267,10 @@ protected:
 
     int getInstruction_impl(int bacterium_index) const;
 
+    Ints getCompletedCommands_impl() const;
+
+    long long getMemoryUsage_impl() const;
+
     void eat_impl(
         const Abstract::Params* params,
         int bacterium_index
@@ -287,6 +331,10 @@ protected:
         int bacterium_index
     );
 
+    std::string snapshot_impl() const;
+
+    void restore_impl(const std::string& image);
+
 private:
     ModelPtr model_;
     Ints remaining_actions_;
@@ -313,9 +361,16 @@ private:
 
     int checkCommandsNumber(int number) const;
 
+    void checkInstruction(int instruction, const char* command) const;
+
     void repeater(RepeaterParams* params);
+
+    void bulkRepeater(RepeaterParams* params);
 };
 
+typedef BasicChanger<CheckedPolicy> Changer;
+typedef BasicChanger<TrustedPolicy> TrustedChanger;
+
 }
 
 #endif
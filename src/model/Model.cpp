@@ -6,15 +6,29 @@
  */
 
 #include "Model.hpp"
-#include "random.hpp"
+#include "BinaryStream.hpp"
+#include "Trace.hpp"
 
 namespace Abstract {
 
+void checkModelParams(int width, int height, int bacteria, int teams) {
+    bool less = ((width < MIN_WIDTH) || (height < MIN_HEIGHT));
+    bool greater = ((width > MAX_WIDTH) || (height > MAX_WIDTH));
+    if (less || greater) {
+        throw Exception("Model: width or height of board "
+                        "is out of allowable range.");
+    }
+    if ((bacteria * teams) > ((width * height) / 2)) {
+        throw Exception("Error: invalid number of creatures");
+    }
+}
+
 Model::Model(
     int /*width*/,
     int /*height*/,
     int /*bacteria*/,
-    int /*teams*/
+    int /*teams*/,
+    unsigned int /*seed*/
 ) {
 }
 
@@ -33,6 +47,18 @@ bool Point::operator==(const Point& p) const {
     return (p.x == x) && (p.y == y);
 }
 
+TeamStats::TeamStats()
+    : alive(0)
+    , mass(0)
+    , clones(0)
+    , deaths(0) {
+}
+
+ModelMemory::ModelMemory()
+    : board(0)
+    , bacteria(0) {
+}
+
 void Model::clearBeforeMove(int team) {
     return clearBeforeMove_impl(team);
 }
@@ -59,6 +85,28 @@ int Model::getTeamByCoordinates(
     return getTeamByCoordinates_impl(coordinates);
 }
 
+int Model::getInstructionByCoordinates(
+    const Point& coordinates
+) const {
+    return getInstructionByCoordinates_impl(coordinates);
+}
+
+Point Model::getNeighbour(
+    const Point& coordinates,
+    int direction
+) const {
+    return getNeighbour_impl(coordinates, direction);
+}
+
+bool Model::roundEnemySearch(
+    const Point& coordinates,
+    int direction,
+    int team,
+    Point* enemy
+) const {
+    return roundEnemySearch_impl(coordinates, direction, team, enemy);
+}
+
 int Model::getWidth() const {
     return getWidth_impl();
 }
@@ -67,10 +115,30 @@ int Model::getHeight() const {
     return getHeight_impl();
 }
 
+int Model::getTeamsNumber() const {
+    return getTeamsNumber_impl();
+}
+
 int Model::getBacteriaNumber(int team) const {
     return getBacteriaNumber_impl(team);
 }
 
+int Model::getListSize(int team) const {
+    return getListSize_impl(team);
+}
+
+TeamStats Model::getTeamStats(int team) const {
+    return getTeamStats_impl(team);
+}
+
+int Model::getAliveTeams() const {
+    return getAliveTeams_impl();
+}
+
+ModelMemory Model::getMemoryUsage() const {
+    return getMemoryUsage_impl();
+}
+
 bool Model::isAlive(int team, int bacterium_index) const {
     return isAlive_impl(team, bacterium_index);
 }
@@ -167,21 +235,88 @@ void Model::createNewByCoordinates(
     );
 }
 
+int Model::random(int end) {
+    return random_impl(end);
 }
 
-namespace Implementation {
+void Model::reset(
+    int width,
+    int height,
+    int bacteria,
+    int teams,
+    unsigned int seed
+) {
+    return reset_impl(width, height, bacteria, teams, seed);
+}
+
+void Model::populate(
+    int width,
+    int height,
+    int teams,
+    const UnitList& bacteria,
+    unsigned int seed
+) {
+    return populate_impl(width, height, teams, bacteria, seed);
+}
 
-static bool isNull(UnitPtr unit_ptr) {
-    return unit_ptr.isNull();
+std::string Model::snapshot() const {
+    return snapshot_impl();
 }
 
+void Model::restore(const std::string& image) {
+    return restore_impl(image);
+}
+
+ModelPtr Model::fork() const {
+    return fork_impl();
+}
+
+void Model::reseed(unsigned int seed) {
+    reseed_impl(seed);
+}
+
+}
+
+namespace Implementation {
+
+// values of cells of board_ and elements of teams_
+// which do not refer to units
+static const int NO_UNIT = -1;
+static const int BORDER = -2;
+
 static bool checkIndex(int index, int size) {
     return (index >= 0) && (index < size);
 }
 
+// copies elements between vectors of different storages
+template<typename TTarget, typename TSource>
+static void copyVector(TTarget& target, const TSource& source) {
+    target.clear();
+    for (int i = 0; i < source.size(); i++) {
+        target.push_back(source[i]);
+    }
+}
+
+// Shifts of coordinates per direction (LEFT, FORWARD, RIGHT, BACKWARD)
+static const int DELTA_X[] = {-1, 0, 1, 0};
+static const int DELTA_Y[] = {0, 1, 0, -1};
+
+// Shifts of 8 cells around in terms of direction (d) and
+// the direction to the right of it (r): d, d+r, r, r-d,
+// -d, -d-r, -r, d-r (clockwise round)
+static const int RING_D[] = {1, 1, 0, -1, -1, -1, 0, 1};
+static const int RING_R[] = {0, 1, 1, 1, 0, -1, -1, -1};
+
+// header of images made by snapshot()
+static const char SNAPSHOT_MAGIC[] = "BCTM";
+static const int SNAPSHOT_MAGIC_SIZE = 4;
+// increment when the format of the image changes
+static const uint32_t SNAPSHOT_VERSION = 1;
+
 /* get global coordinate from horizontal and
-   vertical coordinates
+   vertical coordinates (board has a border of width 1)
 */
+template<typename Policy>
 static int getIndex(
     const Abstract::Point& coordinates,
     int width,
@@ -190,16 +325,23 @@ static int getIndex(
     bool less = ((coordinates.x < 0) || (coordinates.y < 0));
     bool greater = ((coordinates.x >= width) ||
                     (coordinates.y >= height));
-    if (less || greater) {
+    if (Policy::CHECK && (less || greater)) {
         throw Exception(
             "Model: index of cell in arguments "
             "of some methods is out of range."
         );
     }
-    int index = coordinates.y * width + coordinates.x;
+    int index = (coordinates.y + 1) * (width + 2) + coordinates.x + 1;
     return index;
 }
 
+Unit::Unit()
+    : mass(0)
+    , direction(0)
+    , team(0)
+    , instruction(0) {
+}
+
 Unit::Unit(
     const Abstract::Point& coordinates,
     int mass,
@@ -214,94 +356,172 @@ Unit::Unit(
     , instruction(instruction) {
 }
 
-Model::Model(
+template<typename Policy, typename Storage>
+BasicModel<Policy, Storage>::BasicModel(
     int width,
     int height,
     int bacteria,
-    int teams
+    int teams,
+    unsigned int seed
 )
-    : Abstract::Model(width, height, bacteria, teams)
-    , width_(width)
-    , height_(height) {
-    board_.resize(width * height);
-    teams_.resize(teams);
-    dead_bacteria_.resize(teams, 0);
-    initializeBoard(bacteria, teams);
+    : Abstract::Model(width, height, bacteria, teams, seed) {
+    initialize(width, height, bacteria, teams, seed);
 }
 
-void Model::clearBeforeMove_impl(int team) {
-    if (!checkIndex(team, teams_.size())) {
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::clearBeforeMove_impl(int team) {
+    if (Policy::CHECK && !checkIndex(team, teams_.size())) {
         throw Exception(
             "Model: team argument of "
             "clearBeforeMove() method is out of "
             "allowable range."
         );
     }
-    Units::iterator begin = teams_[team].begin();
-    Units::iterator end = teams_[team].end();
-    teams_[team].erase(std::remove_if(begin, end, isNull), end);
+    TRACE_SCOPE("compaction", team);
+    // remove dead bacteria keeping order of alive ones
+    IntVector& bacteria = teams_[team];
+    int alive = 0;
+    for (int b = 0; b < bacteria.size(); b++) {
+        int unit = bacteria[b];
+        if (unit != NO_UNIT) {
+            if (alive != b) {
+                bacteria.edit(alive) = unit;
+            }
+            alive++;
+        }
+    }
+    bacteria.resize(alive);
     dead_bacteria_[team] = 0;
 }
 
-Abstract::CellState Model::cellState_impl(
+template<typename Policy, typename Storage>
+Abstract::CellState BasicModel<Policy, Storage>::cellState_impl(
     const Abstract::Point& coordinates
 ) const {
-    int index = getIndex(coordinates, width_, height_);
-    UnitPtr unit_ptr = board_[index];
-    if (!unit_ptr.isNull()) {
+    int index = getIndex<Policy>(coordinates, width_, height_);
+    if (board_[index] != NO_UNIT) {
         return Abstract::BACTERIUM;
     } else {
         return Abstract::EMPTY;
     }
 }
 
-int Model::getDirectionByCoordinates_impl(
+template<typename Policy, typename Storage>
+int BasicModel<Policy, Storage>::getDirectionByCoordinates_impl(
     const Abstract::Point& coordinates
 ) const {
-    int index = getIndex(coordinates, width_, height_);
-    UnitPtr unit_ptr = board_[index];
-    if (!unit_ptr.isNull()) {
-        return unit_ptr->direction;
-    } else {
+    int index = getIndex<Policy>(coordinates, width_, height_);
+    int unit = board_[index];
+    if (Policy::CHECK && (unit == NO_UNIT)) {
         throw Exception("Error: Attempt to get direction of empty cell.");
     }
+    return units_[unit].direction;
 }
 
-int Model::getMassByCoordinates_impl(
+template<typename Policy, typename Storage>
+int BasicModel<Policy, Storage>::getMassByCoordinates_impl(
     const Abstract::Point& coordinates
 ) const {
-    int index = getIndex(coordinates, width_, height_);
-    UnitPtr unit_ptr = board_[index];
-    if (!unit_ptr.isNull()) {
-        return unit_ptr->mass;
-    } else {
+    int index = getIndex<Policy>(coordinates, width_, height_);
+    int unit = board_[index];
+    if (Policy::CHECK && (unit == NO_UNIT)) {
         throw Exception("Error: Attempt to get mass of empty cell.");
     }
+    return units_[unit].mass;
 }
 
-int Model::getTeamByCoordinates_impl(
+template<typename Policy, typename Storage>
+int BasicModel<Policy, Storage>::getTeamByCoordinates_impl(
     const Abstract::Point& coordinates
 ) const {
-    int index = getIndex(coordinates, width_, height_);
-    UnitPtr unit_ptr = board_[index];
-    if (!unit_ptr.isNull()) {
-        return unit_ptr->team;
-    } else {
+    int index = getIndex<Policy>(coordinates, width_, height_);
+    int unit = board_[index];
+    if (Policy::CHECK && (unit == NO_UNIT)) {
         // no unit in the current cell
         throw Exception("Error: Attempt to get team of empty cell.");
     }
+    return units_[unit].team;
+}
+
+template<typename Policy, typename Storage>
+int BasicModel<Policy, Storage>::getInstructionByCoordinates_impl(
+    const Abstract::Point& coordinates
+) const {
+    int index = getIndex<Policy>(coordinates, width_, height_);
+    int unit = board_[index];
+    if (Policy::CHECK && (unit == NO_UNIT)) {
+        throw Exception(
+            "Error: Attempt to get instruction of empty cell."
+        );
+    }
+    return units_[unit].instruction;
+}
+
+template<typename Policy, typename Storage>
+Abstract::Point BasicModel<Policy, Storage>::getNeighbour_impl(
+    const Abstract::Point& coordinates,
+    int direction
+) const {
+    checkDirection(direction);
+    int index = getIndex<Policy>(coordinates, width_, height_);
+    if (board_[index + offsets_[direction]] == BORDER) {
+        return coordinates;
+    }
+    return Abstract::Point(
+        coordinates.x + DELTA_X[direction],
+        coordinates.y + DELTA_Y[direction]
+    );
+}
+
+template<typename Policy, typename Storage>
+bool BasicModel<Policy, Storage>::roundEnemySearch_impl(
+    const Abstract::Point& coordinates,
+    int direction,
+    int team,
+    Abstract::Point* enemy
+) const {
+    checkDirection(direction);
+    int index = getIndex<Policy>(coordinates, width_, height_);
+    const int* ring = ring_offsets_[direction];
+    for (int i = 0; i < 8; i++) {
+        int unit = board_[index + ring[i]];
+        // NO_UNIT and BORDER are negative
+        if ((unit >= 0) && (units_[unit].team != team)) {
+            if (enemy != NULL) {
+                int right = (direction + 1) % 4;
+                int dx = RING_D[i] * DELTA_X[direction] +
+                         RING_R[i] * DELTA_X[right];
+                int dy = RING_D[i] * DELTA_Y[direction] +
+                         RING_R[i] * DELTA_Y[right];
+                *enemy = Abstract::Point(
+                    coordinates.x + dx,
+                    coordinates.y + dy
+                );
+            }
+            return true;
+        }
+    }
+    return false;
 }
 
-int Model::getWidth_impl() const {
+template<typename Policy, typename Storage>
+int BasicModel<Policy, Storage>::getWidth_impl() const {
     return width_;
 }
 
-int Model::getHeight_impl() const {
+template<typename Policy, typename Storage>
+int BasicModel<Policy, Storage>::getHeight_impl() const {
     return height_;
 }
 
-int Model::getBacteriaNumber_impl(int team) const {
-    if (!checkIndex(team, teams_.size())) {
+template<typename Policy, typename Storage>
+int BasicModel<Policy, Storage>::getTeamsNumber_impl() const {
+    return teams_.size();
+}
+
+template<typename Policy, typename Storage>
+int BasicModel<Policy, Storage>::getBacteriaNumber_impl(int team) const {
+    if (Policy::CHECK && !checkIndex(team, teams_.size())) {
         throw Exception(
             "Model: team argument of "
             "getBacteriaNumber() method is out of "
@@ -312,159 +532,562 @@ int Model::getBacteriaNumber_impl(int team) const {
     return teams_[team].size();
 }
 
-bool Model::isAlive_impl(
+template<typename Policy, typename Storage>
+int BasicModel<Policy, Storage>::getListSize_impl(int team) const {
+    if (Policy::CHECK && !checkIndex(team, teams_.size())) {
+        throw Exception(
+            "Model: team argument of "
+            "getListSize() method is out of "
+            "allowable range."
+        );
+    }
+    return teams_[team].size();
+}
+
+template<typename Policy, typename Storage>
+Abstract::TeamStats BasicModel<Policy, Storage>::getTeamStats_impl(int team) const {
+    if (Policy::CHECK && !checkIndex(team, teams_.size())) {
+        throw Exception(
+            "Model: team argument of "
+            "getTeamStats() method is out of "
+            "allowable range."
+        );
+    }
+    return team_stats_[team];
+}
+
+template<typename Policy, typename Storage>
+int BasicModel<Policy, Storage>::getAliveTeams_impl() const {
+    return alive_teams_;
+}
+
+template<typename Policy, typename Storage>
+Abstract::ModelMemory BasicModel<Policy, Storage>::getMemoryUsage_impl() const {
+    Abstract::ModelMemory memory;
+    memory.board = board_.getMemoryUsage();
+    memory.bacteria = units_.getMemoryUsage() +
+                      free_units_.getMemoryUsage() +
+                      teams_.capacity() * sizeof(IntVector) +
+                      dead_bacteria_.capacity() * sizeof(int) +
+                      team_stats_.capacity() * sizeof(Abstract::TeamStats);
+    for (int team = 0; team < teams_.size(); team++) {
+        memory.bacteria += teams_[team].getMemoryUsage();
+    }
+    return memory;
+}
+
+template<typename Policy, typename Storage>
+bool BasicModel<Policy, Storage>::isAlive_impl(
     int team,
     int bacterium_index
 ) const {
     checkParams(team, bacterium_index, "isAlive()", false);
-    UnitPtr unit_ptr = teams_[team][bacterium_index];
-    return !unit_ptr.isNull();
+    return teams_[team][bacterium_index] != NO_UNIT;
 }
 
-int Model::getInstruction_impl(
+template<typename Policy, typename Storage>
+int BasicModel<Policy, Storage>::getInstruction_impl(
     int team,
     int bacterium_index
 ) const {
     checkParams(team, bacterium_index, "getInstruction()", true);
-    UnitPtr unit_ptr = teams_[team][bacterium_index];
-    return unit_ptr->instruction;
+    return units_[teams_[team][bacterium_index]].instruction;
 }
 
-Abstract::Point Model::getCoordinates_impl(
+template<typename Policy, typename Storage>
+Abstract::Point BasicModel<Policy, Storage>::getCoordinates_impl(
     int team,
     int bacterium_index
 ) const {
     checkParams(team, bacterium_index, "getCoordinates()", true);
-    UnitPtr unit_ptr = teams_[team][bacterium_index];
-    Abstract::Point coordinates = unit_ptr->coordinates;
-    return coordinates;
+    return units_[teams_[team][bacterium_index]].coordinates;
 }
 
-int Model::getDirection_impl(int team, int bacterium_index) const {
+template<typename Policy, typename Storage>
+int BasicModel<Policy, Storage>::getDirection_impl(
+    int team,
+    int bacterium_index
+) const {
     checkParams(team, bacterium_index, "getDirection()", true);
-    UnitPtr unit_ptr = teams_[team][bacterium_index];
-    return unit_ptr->direction;
+    return units_[teams_[team][bacterium_index]].direction;
 }
 
-int Model::getMass_impl(int team, int bacterium_index) const {
+template<typename Policy, typename Storage>
+int BasicModel<Policy, Storage>::getMass_impl(
+    int team,
+    int bacterium_index
+) const {
     checkParams(team, bacterium_index, "getMass()", true);
-    UnitPtr unit_ptr = teams_[team][bacterium_index];
-    return unit_ptr->mass;
+    return units_[teams_[team][bacterium_index]].mass;
 }
 
-void Model::kill_impl(
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::kill_impl(
     int team,
     int bacterium_index
 ) {
     checkParams(team, bacterium_index, "kill()", true);
-    Abstract::Point coordinates =
-        teams_[team][bacterium_index]->coordinates;
-    teams_[team][bacterium_index] = UnitPtr(0);
+    int unit = teams_[team][bacterium_index];
+    teams_[team].edit(bacterium_index) = NO_UNIT;
     dead_bacteria_[team]++;
-    int index = getIndex(coordinates, width_, height_);
-    board_[index] = UnitPtr(0);
+    removeUnit(unit);
 }
 
-void Model::changeMass_impl(
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::changeMass_impl(
     int team,
     int bacterium_index,
     int change
 ) {
     checkParams(team, bacterium_index, "changeMass()", true);
-    UnitPtr unit_ptr = teams_[team][bacterium_index];
-    unit_ptr->mass += change;
+    changeUnitMass(teams_[team][bacterium_index], change);
 }
 
-void Model::setDirection_impl(
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::setDirection_impl(
     int team,
     int bacterium_index,
     int new_direction
 ) {
     checkParams(team, bacterium_index, "setDirection()", true);
-    UnitPtr unit_ptr = teams_[team][bacterium_index];
-    unit_ptr->direction = new_direction;
+    units_.edit(teams_[team][bacterium_index]).direction = new_direction;
 }
 
-void Model::setInstruction_impl(
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::setInstruction_impl(
     int team,
     int bacterium_index,
     int new_instruction
 ) {
     checkParams(team, bacterium_index, "setInstruction()", true);
-    UnitPtr unit_ptr = teams_[team][bacterium_index];
-    unit_ptr->instruction = new_instruction;
+    units_.edit(teams_[team][bacterium_index]).instruction =
+        new_instruction;
 }
 
-void Model::setCoordinates_impl(
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::setCoordinates_impl(
     int team,
     int bacterium_index,
     const Abstract::Point& coordinates
 ) {
     checkParams(team, bacterium_index, "setCoordinates()", true);
-    UnitPtr unit_ptr = teams_[team][bacterium_index];
-    Abstract::Point prev_coordinates = unit_ptr->coordinates;
-    int prev_index = getIndex(prev_coordinates, width_, height_);
-    int new_index = getIndex(coordinates, width_, height_);
-    board_[prev_index] = UnitPtr(0);
-    board_[new_index] = unit_ptr;
-    unit_ptr->coordinates = coordinates;
+    int unit = teams_[team][bacterium_index];
+    Abstract::Point prev_coordinates = units_[unit].coordinates;
+    int prev_index = getIndex<Policy>(prev_coordinates, width_, height_);
+    int new_index = getIndex<Policy>(coordinates, width_, height_);
+    board_.edit(prev_index) = NO_UNIT;
+    board_.edit(new_index) = unit;
+    units_.edit(unit).coordinates = coordinates;
 }
 
-void Model::killByCoordinates_impl(
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::killByCoordinates_impl(
     const Abstract::Point& coordinates
 ) {
-    int index = getIndex(coordinates, width_, height_);
-    UnitPtr murdered = board_[index];
-    if (murdered.isNull()) {
+    int index = getIndex<Policy>(coordinates, width_, height_);
+    int murdered = board_[index];
+    if (Policy::CHECK && (murdered == NO_UNIT)) {
         throw Exception(
             "Model: Attempt to call killByCoordinates() "
             "with coordinates of empty cell."
         );
     }
-    int team = murdered->team;
-    board_[index] = UnitPtr(0);
-    Units::iterator for_kill = std::find(
-        teams_[team].begin(),
-        teams_[team].end(),
-        murdered
-    );
-    *for_kill = UnitPtr(0);
+    int team = units_[murdered].team;
+    IntVector& bacteria = teams_[team];
+    int for_kill = 0;
+    while (bacteria[for_kill] != murdered) {
+        for_kill++;
+    }
+    bacteria.edit(for_kill) = NO_UNIT;
     dead_bacteria_[team]++;
+    removeUnit(murdered);
 }
 
-void Model::changeMassByCoordinates_impl(
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::changeMassByCoordinates_impl(
     const Abstract::Point& coordinates,
     int change
 ) {
-    int index = getIndex(coordinates, width_, height_);
-    UnitPtr unit_ptr = board_[index];
-    if (!unit_ptr.isNull()) {
-        unit_ptr->mass += change;
-    } else {
+    int index = getIndex<Policy>(coordinates, width_, height_);
+    int unit = board_[index];
+    if (Policy::CHECK && (unit == NO_UNIT)) {
         throw Exception("Error: Attempt to change mass of empty cell.");
     }
+    changeUnitMass(unit, change);
 }
 
-void Model::createNewByCoordinates_impl(
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::createNewByCoordinates_impl(
     const Abstract::Point& coordinates,
     int mass,
     int direction,
     int team,
     int instruction
 ) {
-    UnitPtr unit_ptr(new Unit(
-        coordinates,
-        mass,
-        direction,
-        team,
-        instruction
-    ));
-    teams_[team].push_back(unit_ptr);
-    int index = getIndex(coordinates, width_, height_);
-    board_[index] = unit_ptr;
+    addUnit(Unit(coordinates, mass, direction, team, instruction));
+    team_stats_[team].clones++;
+}
+
+template<typename Policy, typename Storage>
+int BasicModel<Policy, Storage>::random_impl(int end) {
+    return random_.next(end);
+}
+
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::reset_impl(
+    int width,
+    int height,
+    int bacteria,
+    int teams,
+    unsigned int seed
+) {
+    Abstract::checkModelParams(width, height, bacteria, teams);
+    initialize(width, height, bacteria, teams, seed);
+}
+
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::initialize(
+    int width,
+    int height,
+    int bacteria,
+    int teams,
+    unsigned int seed
+) {
+    random_.seed(seed);
+    width_ = width;
+    height_ = height;
+    initializeBorder(board_, width_, height_);
+    initializeOffsets();
+    // clear() keeps memory of vectors for the next game
+    teams_.resize(teams);
+    for (int team = 0; team < teams; team++) {
+        teams_[team].clear();
+    }
+    dead_bacteria_.assign(teams, 0);
+    team_stats_.assign(teams, Abstract::TeamStats());
+    alive_teams_ = 0;
+    units_.clear();
+    free_units_.clear();
+    initializeBoard(bacteria, teams);
+}
+
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::populate_impl(
+    int width,
+    int height,
+    int teams,
+    const UnitList& bacteria,
+    unsigned int seed
+) {
+    Abstract::checkModelParams(width, height, 0, teams);
+    initialize(width, height, 0, teams, seed);
+    // units_ and board_ are filled directly (without addUnit())
+    units_.resize(bacteria.size());
+    for (int i = 0; i < bacteria.size(); i++) {
+        const Unit& unit = bacteria[i];
+        if (!checkIndex(unit.team, teams) ||
+                !checkIndex(unit.direction, 4) ||
+                (unit.mass <= 0) ||
+                (unit.instruction < 0)) {
+            throw Exception(
+                "Model: team, direction, mass or instruction "
+                "of bacterium is out of allowable range."
+            );
+        }
+        // coordinates are checked even by trusted model
+        int index = getIndex<CheckedPolicy>(
+            unit.coordinates,
+            width_,
+            height_
+        );
+        if (board_[index] != NO_UNIT) {
+            throw Exception("Model: two bacteria in one cell.");
+        }
+        board_.edit(index) = i;
+        units_.edit(i) = unit;
+        teams_[unit.team].push_back(i);
+        Abstract::TeamStats& stats = team_stats_[unit.team];
+        if (stats.alive == 0) {
+            alive_teams_++;
+        }
+        stats.alive++;
+        stats.mass += unit.mass;
+    }
+}
+
+/* Image made by snapshot() (all numbers are 32-bit little-endian):
+   magic, version, width, height, number of teams,
+   state of the random generator,
+   units_ (coordinates, mass, direction, team, instruction),
+   free_units_,
+   for each team: teams_[team], dead_bacteria_[team],
+   clones and deaths of the team.
+   Vectors are stored as size followed by elements.
+   Board and other counters are restored from teams_.
+*/
+template<typename Policy, typename Storage>
+std::string BasicModel<Policy, Storage>::snapshot_impl() const {
+    std::string image;
+    int teams = teams_.size();
+    int units_size = 8 + Random::STATE_SIZE + 1 + units_.size() * 6 +
+                     1 + free_units_.size();
+    for (int team = 0; team < teams; team++) {
+        units_size += 4 + teams_[team].size();
+    }
+    image.reserve(units_size * 4);
+    BinaryWriter writer(image);
+    writer.writeBytes(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE);
+    writer.writeUint(SNAPSHOT_VERSION);
+    writer.writeInt(width_);
+    writer.writeInt(height_);
+    writer.writeInt(teams);
+    uint32_t state[Random::STATE_SIZE];
+    random_.getState(state);
+    for (int i = 0; i < Random::STATE_SIZE; i++) {
+        writer.writeUint(state[i]);
+    }
+    writer.writeInt(units_.size());
+    for (int i = 0; i < units_.size(); i++) {
+        const Unit& unit = units_[i];
+        writer.writeInt(unit.coordinates.x);
+        writer.writeInt(unit.coordinates.y);
+        writer.writeInt(unit.mass);
+        writer.writeInt(unit.direction);
+        writer.writeInt(unit.team);
+        writer.writeInt(unit.instruction);
+    }
+    writer.writeInt(free_units_.size());
+    for (int i = 0; i < free_units_.size(); i++) {
+        writer.writeInt(free_units_[i]);
+    }
+    for (int team = 0; team < teams; team++) {
+        const IntVector& bacteria = teams_[team];
+        writer.writeInt(bacteria.size());
+        for (int b = 0; b < bacteria.size(); b++) {
+            writer.writeInt(bacteria[b]);
+        }
+        writer.writeInt(dead_bacteria_[team]);
+        writer.writeInt(team_stats_[team].clones);
+        writer.writeInt(team_stats_[team].deaths);
+    }
+    return image;
+}
+
+static void checkSnapshot(bool condition) {
+    if (!condition) {
+        throw Exception("Model: invalid snapshot.");
+    }
+}
+
+// Numbers read from the image are checked against the rest of the
+// image before memory is allocated for them.
+static void checkRecords(
+    const BinaryReader& reader,
+    int number,
+    int record_size
+) {
+    checkSnapshot(
+        (number >= 0) &&
+        ((long long)(number) * record_size <= reader.getRemaining())
+    );
+}
+
+// sizes of records of the image (bytes)
+static const int UNIT_RECORD = 6 * 4;
+static const int INDEX_RECORD = 4;
+// size of bacteria list, dead bacteria, clones and deaths
+static const int TEAM_RECORD = 4 * 4;
+
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::restore_impl(const std::string& image) {
+    BinaryReader reader(image);
+    checkSnapshot(reader.readBytes(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE));
+    if (reader.readUint() != SNAPSHOT_VERSION) {
+        throw Exception("Model: unsupported version of snapshot.");
+    }
+    int width = reader.readInt();
+    int height = reader.readInt();
+    int teams = reader.readInt();
+    Abstract::checkModelParams(width, height, 0, teams);
+    checkSnapshot(teams >= 0);
+    uint32_t state[Random::STATE_SIZE];
+    for (int i = 0; i < Random::STATE_SIZE; i++) {
+        state[i] = reader.readUint();
+    }
+    // the state is read into temporaries and replaces the state
+    // of the model only if the whole image is valid
+    int units_number = reader.readInt();
+    checkRecords(reader, units_number, UNIT_RECORD);
+    UnitVector units;
+    units.resize(units_number);
+    for (int i = 0; i < units_number; i++) {
+        Unit& unit = units.edit(i);
+        unit.coordinates.x = reader.readInt();
+        unit.coordinates.y = reader.readInt();
+        unit.mass = reader.readInt();
+        unit.direction = reader.readInt();
+        unit.team = reader.readInt();
+        unit.instruction = reader.readInt();
+    }
+    int free_number = reader.readInt();
+    checkRecords(reader, free_number, INDEX_RECORD);
+    checkSnapshot(free_number <= units_number);
+    IntVector free_units;
+    free_units.resize(free_number);
+    for (int i = 0; i < free_number; i++) {
+        free_units.edit(i) = reader.readInt();
+        checkSnapshot(checkIndex(free_units[i], units_number));
+    }
+    checkRecords(reader, teams, TEAM_RECORD);
+    IntVector board;
+    initializeBorder(board, width, height);
+    std::vector<IntVector> teams_list(teams);
+    Ints dead_bacteria(teams);
+    std::vector<Abstract::TeamStats> team_stats(teams);
+    int alive_teams = 0;
+    for (int team = 0; team < teams; team++) {
+        IntVector& bacteria = teams_list[team];
+        int bacteria_number = reader.readInt();
+        checkRecords(reader, bacteria_number, INDEX_RECORD);
+        bacteria.resize(bacteria_number);
+        Abstract::TeamStats& stats = team_stats[team];
+        int dead = 0;
+        for (int b = 0; b < bacteria_number; b++) {
+            int unit = reader.readInt();
+            bacteria.edit(b) = unit;
+            if (unit == NO_UNIT) {
+                dead++;
+                continue;
+            }
+            checkSnapshot(checkIndex(unit, units_number));
+            const Unit& live = units[unit];
+            checkSnapshot(live.team == team);
+            checkSnapshot(checkIndex(live.direction, 4));
+            checkSnapshot(live.mass > 0);
+            checkSnapshot(live.instruction >= 0);
+            // coordinates are checked even by trusted model
+            int index = getIndex<CheckedPolicy>(
+                live.coordinates,
+                width,
+                height
+            );
+            checkSnapshot(board[index] == NO_UNIT);
+            board.edit(index) = unit;
+            stats.alive++;
+            stats.mass += live.mass;
+        }
+        if (stats.alive > 0) {
+            alive_teams++;
+        }
+        dead_bacteria[team] = reader.readInt();
+        checkSnapshot(dead_bacteria[team] == dead);
+        stats.clones = reader.readInt();
+        stats.deaths = reader.readInt();
+    }
+    checkSnapshot(reader.atEnd());
+    // a slot is used by one bacterium or is free (bacteria of teams
+    // have different cells, so they have different slots)
+    for (int i = 0; i < free_number; i++) {
+        int unit = free_units[i];
+        const Abstract::Point& coordinates = units[unit].coordinates;
+        bool inside = (coordinates.x >= 0) && (coordinates.x < width) &&
+                      (coordinates.y >= 0) && (coordinates.y < height);
+        if (inside) {
+            int index = getIndex<CheckedPolicy>(coordinates, width, height);
+            checkSnapshot(board[index] != unit);
+        }
+    }
+    Bools free_slots(units_number, false);
+    for (int i = 0; i < free_number; i++) {
+        checkSnapshot(!free_slots[free_units[i]]);
+        free_slots[free_units[i]] = true;
+    }
+    std::swap(units_, units);
+    std::swap(free_units_, free_units);
+    std::swap(board_, board);
+    teams_.swap(teams_list);
+    dead_bacteria_.swap(dead_bacteria);
+    team_stats_.swap(team_stats);
+    alive_teams_ = alive_teams;
+    random_.setState(state);
+    width_ = width;
+    height_ = height;
+    initializeOffsets();
+}
+
+template<typename Policy, typename Storage>
+template<typename TOtherStorage>
+BasicModel<Policy, Storage>::BasicModel(
+    const BasicModel<Policy, TOtherStorage>& other
+)
+    : Abstract::Model(other)
+    , dead_bacteria_(other.dead_bacteria_)
+    , team_stats_(other.team_stats_)
+    , alive_teams_(other.alive_teams_)
+    , random_(other.random_)
+    , width_(other.width_)
+    , height_(other.height_) {
+    copyVector(units_, other.units_);
+    copyVector(free_units_, other.free_units_);
+    copyVector(board_, other.board_);
+    teams_.resize(other.teams_.size());
+    for (int team = 0; team < teams_.size(); team++) {
+        copyVector(teams_[team], other.teams_[team]);
+    }
+    std::copy(other.offsets_, other.offsets_ + 4, offsets_);
+    for (int direction = 0; direction < 4; direction++) {
+        std::copy(other.ring_offsets_[direction],
+                  other.ring_offsets_[direction] + 8,
+                  ring_offsets_[direction]);
+    }
+}
+
+template<typename Policy, typename Storage>
+ModelPtr BasicModel<Policy, Storage>::fork_impl() const {
+    // a fork of a plain model copies its state once,
+    // copies of CowVector share chunks with the original
+    return ModelPtr(new BasicModel<Policy, CowStorage>(*this));
+}
+
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::reseed_impl(unsigned int seed) {
+    random_.seed(seed);
 }
 
-void Model::initializeBoard(int bacteria, int teams) {
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::initializeBorder(
+    IntVector& board,
+    int width,
+    int height
+) {
+    board.assign((width + 2) * (height + 2), NO_UNIT);
+    for (int x = 0; x < width + 2; x++) {
+        board.edit(x) = BORDER;
+        board.edit((height + 1) * (width + 2) + x) = BORDER;
+    }
+    for (int y = 0; y < height + 2; y++) {
+        board.edit(y * (width + 2)) = BORDER;
+        board.edit(y * (width + 2) + width + 1) = BORDER;
+    }
+}
+
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::initializeOffsets() {
+    int row = width_ + 2;
+    for (int d = 0; d < 4; d++) {
+        offsets_[d] = DELTA_Y[d] * row + DELTA_X[d];
+    }
+    for (int d = 0; d < 4; d++) {
+        int right = (d + 1) % 4;
+        for (int i = 0; i < 8; i++) {
+            ring_offsets_[d][i] = RING_D[i] * offsets_[d] +
+                                  RING_R[i] * offsets_[right];
+        }
+    }
+}
+
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::initializeBoard(int bacteria, int teams) {
     for (int team = 0; team < teams; team++) {
         for (int bacterium = 0; bacterium < bacteria; bacterium++) {
             tryToPlace(team);
@@ -472,33 +1095,72 @@ void Model::initializeBoard(int bacteria, int teams) {
     }
 }
 
-void Model::tryToPlace(int team) {
-    int x = random(width_);
-    int y = random(height_);
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::tryToPlace(int team) {
+    int x = random_.next(width_);
+    int y = random_.next(height_);
     while (cellState(Abstract::Point(x, y)) != Abstract::EMPTY) {
-        x = random(width_);
-        y = random(height_);
+        x = random_.next(width_);
+        y = random_.next(height_);
     }
-    int direction = random(4);
-    UnitPtr unit_ptr(new Unit(
-        Abstract::Point(x, y),
-        DEFAULT_MASS,
-        direction,
-        team,
-        0
-    ));
-    teams_[team].push_back(unit_ptr);
-    int index = getIndex(Abstract::Point(x, y), width_, height_);
-    board_[index] = unit_ptr;
+    int direction = random_.next(4);
+    addUnit(Unit(Abstract::Point(x, y), DEFAULT_MASS, direction, team, 0));
+}
+
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::addUnit(const Unit& unit) {
+    int index = getIndex<Policy>(unit.coordinates, width_, height_);
+    int unit_index;
+    if (free_units_.empty()) {
+        unit_index = units_.size();
+        units_.push_back(unit);
+    } else {
+        unit_index = free_units_.back();
+        free_units_.pop_back();
+        units_.edit(unit_index) = unit;
+    }
+    teams_[unit.team].push_back(unit_index);
+    board_.edit(index) = unit_index;
+    Abstract::TeamStats& stats = team_stats_[unit.team];
+    if (stats.alive == 0) {
+        alive_teams_++;
+    }
+    stats.alive++;
+    stats.mass += unit.mass;
+}
+
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::removeUnit(int unit_index) {
+    const Abstract::Point& coordinates = units_[unit_index].coordinates;
+    int index = getIndex<Policy>(coordinates, width_, height_);
+    board_.edit(index) = NO_UNIT;
+    free_units_.push_back(unit_index);
+    Abstract::TeamStats& stats = team_stats_[units_[unit_index].team];
+    stats.alive--;
+    stats.mass -= units_[unit_index].mass;
+    stats.deaths++;
+    if (stats.alive == 0) {
+        alive_teams_--;
+    }
+}
+
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::changeUnitMass(int unit_index, int change) {
+    units_.edit(unit_index).mass += change;
+    team_stats_[units_[unit_index].team].mass += change;
 }
 
 #define TO_S std::string
-void Model::checkParams(
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::checkParams(
     int team,
     int bacterium_index,
     const char* method_name,
     bool check_alive
 ) const {
+    if (!Policy::CHECK) {
+        return;
+    }
     if (!checkIndex(team, teams_.size())) {
         throw Exception(
             "Model: team argument of " + TO_S(method_name) +
@@ -512,8 +1174,7 @@ void Model::checkParams(
         );
     }
     if (check_alive) {
-        UnitPtr unit_ptr = teams_[team][bacterium_index];
-        if (unit_ptr.isNull()) {
+        if (teams_[team][bacterium_index] == NO_UNIT) {
             throw Exception(
                 "Model: Attempt to call " + TO_S(method_name) +
                 " with NULL ptr."
@@ -522,11 +1183,12 @@ void Model::checkParams(
     }
 }
 
-void Model::checkDead(
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::checkDead(
     int team,
     const char* method_name
 ) const {
-    if (dead_bacteria_[team] > 0) {
+    if (Policy::CHECK && (dead_bacteria_[team] > 0)) {
         throw Exception(
             "Model: there are some dead bacteria; you "
             "must call clearBeforeMove() before " + TO_S(method_name)
@@ -535,4 +1197,17 @@ void Model::checkDead(
 }
 #undef TO_S
 
+template<typename Policy, typename Storage>
+void BasicModel<Policy, Storage>::checkDirection(int direction) const {
+    if (Policy::CHECK && !checkIndex(direction, 4)) {
+        throw Exception("Model: direction is out of allowable range.");
+    }
+}
+
+// explicit instantiation of both validation policies and storages
+template class BasicModel<CheckedPolicy, PlainStorage>;
+template class BasicModel<TrustedPolicy, PlainStorage>;
+template class BasicModel<CheckedPolicy, CowStorage>;
+template class BasicModel<TrustedPolicy, CowStorage>;
+
 }
@@ -9,26 +9,30 @@
 #define MODEL_HPP_
 
 #include <algorithm>
+#include <string>
 #include <vector>
 
 #include "CoreGlobals.hpp"
 #include "CoreConstants.hpp"
+#include "CowVector.hpp"
 #include "Exception.hpp"
+#include "PlainVector.hpp"
+#include "random.hpp"
 
 namespace Abstract {
 
+void checkModelParams(int width, int height, int bacteria, int teams);
+
 template<typename TModel>
-TModel* makeModel(int width, int height, int bacteria, int teams) {
-    bool less = ((width < MIN_WIDTH) || (height < MIN_HEIGHT));
-    bool greater = ((width > MAX_WIDTH) || (height > MAX_WIDTH));
-    if (less || greater) {
-        throw Exception("Model: width or height of board "
-                        "is out of allowable range.");
-    }
-    if ((bacteria * teams) > ((width * height) / 2)) {
-        throw Exception("Error: invalid number of creatures");
-    }
-    TModel* model = new TModel(width, height, bacteria, teams);
+TModel* makeModel(
+    int width,
+    int height,
+    int bacteria,
+    int teams,
+    unsigned int seed = DEFAULT_SEED
+) {
+    checkModelParams(width, height, bacteria, teams);
+    TModel* model = new TModel(width, height, bacteria, teams, seed);
     return model;
 }
 
@@ -54,6 +58,30 @@ struct Point {
     int x, y;
 };
 
+/** Live counters of a team, updated by every change of the model */
+struct TeamStats {
+    TeamStats();
+
+    // number of alive bacteria
+    int alive;
+    // total mass of alive bacteria
+    int mass;
+    // number of bacteria created by createNewByCoordinates()
+    int clones;
+    // number of killed bacteria
+    int deaths;
+};
+
+/** Heap memory used by the model (bytes) */
+struct ModelMemory {
+    ModelMemory();
+
+    // cells of the board
+    long long board;
+    // units, free units, lists of bacteria and counters of teams
+    long long bacteria;
+};
+
 class Model {
 public:
     void clearBeforeMove(int team);
@@ -68,12 +96,44 @@ public:
 
     int getTeamByCoordinates(const Point& coordinates) const;
 
+    int getInstructionByCoordinates(const Point& coordinates) const;
+
+    // neighbouring cell in the direction
+    // (the same cell if it is on the border of the board)
+    Point getNeighbour(
+        const Point& coordinates,
+        int direction
+    ) const;
+
+    // search for bacterium of other team in 8 cells
+    // around (clockwise, starting from the direction)
+    bool roundEnemySearch(
+        const Point& coordinates,
+        int direction,
+        int team,
+        Point* enemy = NULL
+    ) const;
+
     int getWidth() const;
 
     int getHeight() const;
 
+    int getTeamsNumber() const;
+
     int getBacteriaNumber(int team) const;
 
+    // size of the list of the team, places of dead bacteria
+    // are counted too (does not need clearBeforeMove())
+    int getListSize(int team) const;
+
+    // counters of the team (do not need clearBeforeMove())
+    TeamStats getTeamStats(int team) const;
+
+    // number of teams which have alive bacteria
+    int getAliveTeams() const;
+
+    ModelMemory getMemoryUsage() const;
+
     bool isAlive(int team, int bacterium_index) const;
 
     int getInstruction(int team, int bacterium_index) const;
@@ -126,8 +186,62 @@ public:
         int instruction
     );
 
+    // random number from interval [0, end),
+    // generator is seeded by makeModel()
+    int random(int end);
+
+    // start new game on this model (reusing its memory);
+    // arguments are the same as arguments of makeModel()
+    void reset(
+        int width,
+        int height,
+        int bacteria,
+        int teams,
+        unsigned int seed
+    );
+
+    // start new game with the given bacteria (e.g. loaded
+    // from a map) instead of random ones; bacteria are placed
+    // in one pass and validated even by trusted model
+    // (coordinates, free cells, teams, directions and masses)
+    void populate(
+        int width,
+        int height,
+        int teams,
+        const UnitList& bacteria,
+        unsigned int seed
+    );
+
+    // binary image of the whole state of the model
+    // (board, bacteria, dead counters, counters of teams
+    // and state of the random generator)
+    std::string snapshot() const;
+
+    // replace state of the model with the image made by snapshot()
+    // (size of the board and number of teams are taken from it);
+    // throws if the image is invalid, the model is not changed then
+    void restore(const std::string& image);
+
+    // independent copy of the model, e.g. for lookahead;
+    // the fork keeps its state in copy-on-write storage: the first
+    // fork copies the state, forks of a fork share unchanged memory
+    // with it (and must be used in the thread of it, see CowVector);
+    // random generator continues the sequence of this model
+    // (use reseed() to make forks play different rollouts)
+    ModelPtr fork() const;
+
+    // restart the random generator from the seed
+    // (the board and bacteria are not changed)
+    void reseed(unsigned int seed);
+
 protected:
-    Model(int width, int height, int bacteria, int teams);
+    Model(
+        int width,
+        int height,
+        int bacteria,
+        int teams,
+        unsigned int seed
+    );
 
     virtual void clearBeforeMove_impl(int team) = 0;
 
@@ -147,12 +261,38 @@ protected:
         const Point& coordinates
     ) const = 0;
 
+    virtual int getInstructionByCoordinates_impl(
+        const Point& coordinates
+    ) const = 0;
+
+    virtual Point getNeighbour_impl(
+        const Point& coordinates,
+        int direction
+    ) const = 0;
+
+    virtual bool roundEnemySearch_impl(
+        const Point& coordinates,
+        int direction,
+        int team,
+        Point* enemy
+    ) const = 0;
+
     virtual int getWidth_impl() const = 0;
 
     virtual int getHeight_impl() const = 0;
 
+    virtual int getTeamsNumber_impl() const = 0;
+
     virtual int getBacteriaNumber_impl(int team) const = 0;
 
+    virtual int getListSize_impl(int team) const = 0;
+
+    virtual TeamStats getTeamStats_impl(int team) const = 0;
+
+    virtual int getAliveTeams_impl() const = 0;
+
+    virtual ModelMemory getMemoryUsage_impl() const = 0;
+
     virtual bool isAlive_impl(
         int team,
         int bacterium_index
@@ -223,6 +363,32 @@ protected:
         int team,
         int instruction
     ) = 0;
+
+    virtual int random_impl(int end) = 0;
+
+    virtual void reset_impl(
+        int width,
+        int height,
+        int bacteria,
+        int teams,
+        unsigned int seed
+    ) = 0;
+
+    virtual void populate_impl(
+        int width,
+        int height,
+        int teams,
+        const UnitList& bacteria,
+        unsigned int seed
+    ) = 0;
+
+    virtual std::string snapshot_impl() const = 0;
+
+    virtual void restore_impl(const std::string& image) = 0;
+
+    virtual ModelPtr fork_impl() const = 0;
+
+    virtual void reseed_impl(unsigned int seed) = 0;
 };
 
 }
@@ -230,6 +396,8 @@ protected:
 namespace Implementation {
 
 struct Unit {
+    Unit();
+
     Unit(
         const Abstract::Point& coordinates,
         int mass,
@@ -245,9 +413,44 @@ struct Unit {
     int instruction;
 };
 
-class Model : public Abstract::Model {
+/** Validation policy: arguments of all methods are checked */
+struct CheckedPolicy {
+    static const bool CHECK = true;
+};
+
+/** Validation policy: arguments are trusted (not checked).
+Use it only for scripts which run without errors in
+checked variant (e.g. inside of the engine loop).
+*/
+struct TrustedPolicy {
+    static const bool CHECK = false;
+};
+
+/** Storage of the model: plain vectors (fastest access) */
+struct PlainStorage {
+    template<typename T>
+    using Vector = PlainVector<T>;
+};
+
+/** Storage of forks: copies share memory (see CowVector) */
+struct CowStorage {
+    template<typename T>
+    using Vector = CowVector<T>;
+};
+
+template<typename TPolicy, typename TStorage = PlainStorage>
+class BasicModel : public Abstract::Model {
 public:
-    Model(int width, int height, int bacteria, int teams);
+    typedef TPolicy Policy;
+    typedef TStorage Storage;
+
+    BasicModel(
+        int width,
+        int height,
+        int bacteria,
+        int teams,
+        unsigned int seed
+    );
 
 protected:
     void clearBeforeMove_impl(int team);
@@ -268,12 +471,38 @@ protected:
         const Abstract::Point& coordinates
     ) const;
 
+    int getInstructionByCoordinates_impl(
+        const Abstract::Point& coordinates
+    ) const;
+
+    Abstract::Point getNeighbour_impl(
+        const Abstract::Point& coordinates,
+        int direction
+    ) const;
+
+    bool roundEnemySearch_impl(
+        const Abstract::Point& coordinates,
+        int direction,
+        int team,
+        Abstract::Point* enemy
+    ) const;
+
     int getWidth_impl() const;
 
     int getHeight_impl() const;
 
+    int getTeamsNumber_impl() const;
+
     int getBacteriaNumber_impl(int team) const;
 
+    int getListSize_impl(int team) const;
+
+    Abstract::TeamStats getTeamStats_impl(int team) const;
+
+    int getAliveTeams_impl() const;
+
+    Abstract::ModelMemory getMemoryUsage_impl() const;
+
     bool isAlive_impl(int team, int bacterium_index) const;
 
     int getInstruction_impl(int team, int bacterium_index) const;
@@ -326,7 +555,49 @@ protected:
         int instruction
     );
 
+    int random_impl(int end);
+
+    void reset_impl(
+        int width,
+        int height,
+        int bacteria,
+        int teams,
+        unsigned int seed
+    );
+
+    void populate_impl(
+        int width,
+        int height,
+        int teams,
+        const UnitList& bacteria,
+        unsigned int seed
+    );
+
+    std::string snapshot_impl() const;
+
+    void restore_impl(const std::string& image);
+
+    ModelPtr fork_impl() const;
+
+    void reseed_impl(unsigned int seed);
+
 private:
+    template<typename, typename>
+    friend class BasicModel;
+
+    typedef typename Storage::template Vector<int> IntVector;
+    typedef typename Storage::template Vector<Unit> UnitVector;
+
+    void initialize(
+        int width,
+        int height,
+        int bacteria,
+        int teams,
+        unsigned int seed
+    );
+
+    static void initializeBorder(IntVector& board, int width, int height);
+
     void initializeBoard(int bacteria, int teams);
 
     void tryToPlace(int team);
@@ -343,17 +614,62 @@ private:
         const char* method_name
     ) const;
 
-    Units board_;
-    Teams teams_;
+    void checkDirection(int direction) const;
+
+    void initializeOffsets();
+
+    void addUnit(const Unit& unit);
+
+    void removeUnit(int unit_index);
+
+    void changeUnitMass(int unit_index, int change);
+
+    // copy of the model with other storage (see fork())
+    template<typename TOtherStorage>
+    explicit BasicModel(const BasicModel<Policy, TOtherStorage>& other);
+
+    // Units of all teams. Places of dead units are listed
+    // in free_units_ and are reused by new units.
+    // Big vectors are stored in Storage (copy-on-write in forks).
+    UnitVector units_;
+    IntVector free_units_;
+
+    // board_[cell] and teams_[team][bacterium_index] are indices
+    // in units_ (negative values mean empty cell, dead bacterium
+    // and the border of the board, see Model.cpp).
+    // The board has a border of sentinel cells,
+    // so neighbours of any cell of the board are valid indices.
+    // Index of cell (x, y) is (y + 1) * (width_ + 2) + (x + 1).
+    IntVector board_;
+    std::vector<IntVector> teams_;
+
+    // offsets_[direction] is a difference of indices of
+    // the cell and its neighbour in the direction
+    int offsets_[4];
+
+    // ring_offsets_[direction] are offsets of 8 cells around
+    // (clockwise, starting from the cell in the direction)
+    int ring_offsets_[4][8];
 
     // dead_bacteria_[team] is a number of dead bacteria for this team.
     // dead_bacteria_[team] is 0 after calling clearBeforeMove(team).
     Ints dead_bacteria_;
 
+    // team_stats_[team] are counters of the team,
+    // they are updated by addUnit(), removeUnit() and
+    // changeUnitMass()
+    std::vector<Abstract::TeamStats> team_stats_;
+    int alive_teams_;
+
+    Random random_;
+
     int width_;
     int height_;
 };
 
+typedef BasicModel<CheckedPolicy> Model;
+typedef BasicModel<TrustedPolicy> TrustedModel;
+
 }
 
 #endif
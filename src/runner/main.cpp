@@ -0,0 +1,717 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+// bacteria-run: plays scripts headless and prints results.
+// With --batch plays many independent games in parallel.
+// With --tournament plays round-robin tournament of scripts.
+// With --record saves the game, --replay reproduces saved game.
+// With --frames writes frames of the game for visualization.
+// With --evolve evolves scripts against the given ones.
+// With --map starts the game on a YAML map, --result writes
+// the result and the final board as a YAML map.
+// With --counters prints hot path counters (if built with them).
+// With --trace writes timeline of the engine as Chrome trace.
+// With --profile prints dispatches and cycles of script lines.
+// With --memory prints heap memory used by the game.
+// With --lockstep compares checked and trusted engines on random games.
+// With --metrics-port serves live metrics for Prometheus.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+
+#include "Game.hpp"
+#include "BatchRunner.hpp"
+#include "Tournament.hpp"
+#include "Replay.hpp"
+#include "FrameStream.hpp"
+#include "MapYaml.hpp"
+#include "Evolution.hpp"
+#include "Counters.hpp"
+#include "Trace.hpp"
+#include "Lockstep.hpp"
+#include "Metrics.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static const int DEFAULT_MOVES = 1000;
+
+static void usage() {
+    std::cerr << "Usage: bacteria-run [options] script1 script2 ...\n"
+              << "       bacteria-run [options] --batch jobs\n"
+              << "       bacteria-run [options] --tournament script1 ...\n"
+              << "       bacteria-run [options] --evolve G script1 ...\n"
+              << "       bacteria-run --replay FILE [--seek M] [--verify]\n"
+              << "       bacteria-run --show-frames FILE [--seek M]\n"
+              << "       bacteria-run [options] --lockstep N\n"
+              << "Options:\n"
+              << "  --width W       width of board\n"
+              << "  --height H      height of board\n"
+              << "  --bacteria N    initial bacteria per team\n"
+              << "  --moves M       maximum number of moves\n"
+              << "  --seed S        seed of random generator\n"
+              << "  --trusted       do not validate commands at run time\n"
+              << "                  (scripts are validated when compiled)\n"
+              << "  --batch FILE    play jobs from FILE, one per line:\n"
+              << "                  width height bacteria seed moves"
+              << " script1 script2 ...\n"
+              << "  --threads T     number of threads for --batch"
+              << " and --tournament\n"
+              << "  --tournament    play every pair of scripts\n"
+              << "  --seeds K       games of every pair in tournament"
+              << " and evolution\n"
+              << "  --ffa N         add free-for-all games of N teams"
+              << " to tournament\n"
+              << "  --evolve G      evolve scripts for G generations"
+              << " against given scripts\n"
+              << "  --population P  number of scripts in a generation\n"
+              << "  --record FILE   save replay of the game to FILE"
+              << " (with --map too)\n"
+              << "  --keyframe-interval N  moves between keyframes"
+              << " of replay\n"
+              << "  --replay FILE   reproduce the game saved by --record\n"
+              << "  --seek M        show state after move M of replay\n"
+              << "  --verify        check states of replay"
+              << " against recorded hashes\n"
+              << "  --frames FILE   write frames of the game to FILE\n"
+              << "  --full-frame-interval N  frames between full frames\n"
+              << "  --show-frames FILE  print frame M of FILE\n"
+              << "  --map FILE      start the game on YAML map"
+              << " (size, seed and bacteria)\n"
+              << "  --result FILE   write result and final board"
+              << " as YAML map\n"
+              << "  --counters      print counters of commands, deaths"
+              << " and time of moves\n"
+              << "                  (cmake -DBACTERIA_COUNTERS=ON)\n"
+              << "  --trace FILE    write timeline of moves"
+              << " as Chrome trace JSON\n"
+              << "  --profile       print dispatches and cycles"
+              << " of every line of scripts\n"
+              << "  --memory        print memory used by the game\n"
+              << "  --lockstep N    play N random games on checked"
+              << " and trusted engines\n"
+              << "                  and print the first difference\n"
+              << "  --metrics-port P  serve metrics on"
+              << " http://127.0.0.1:P/metrics while playing\n";
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream file(path.c_str());
+    if (!file) {
+        throw Exception("Unable to read file " + path);
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+static void writeFile(const std::string& path, const std::string& data) {
+    std::ofstream file(path.c_str(), std::ios::binary);
+    file << data;
+    if (!file) {
+        throw Exception("Unable to write file " + path);
+    }
+}
+
+static std::string stringArgument(int argc, char** argv, int& i) {
+    if (i + 1 >= argc) {
+        throw Exception(std::string("Missing value of ") + argv[i]);
+    }
+    i++;
+    return argv[i];
+}
+
+static int intArgument(int argc, char** argv, int& i) {
+    return atoi(stringArgument(argc, argv, i).c_str());
+}
+
+static void printGame(
+    const Implementation::Game& game,
+    const Strings& names
+) {
+    std::cout << "moves: " << game.getMoveNumber() << std::endl;
+    for (int team = 0; team < game.getTeamsNumber(); team++) {
+        std::cout << "team " << team << " (" << names[team]
+                  << "): bacteria " << game.getBacteriaNumber(team)
+                  << ", mass " << game.getTotalMass(team)
+                  << std::endl;
+    }
+    int winner = game.getWinner();
+    if (game.isOver() && (winner != -1)) {
+        std::cout << "winner: team " << winner << std::endl;
+    } else {
+        std::cout << "winner: none" << std::endl;
+    }
+}
+
+static int playWithFrames(
+    Implementation::Game& game,
+    int moves,
+    const std::string& path,
+    int full_frame_interval
+) {
+    std::ofstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        throw Exception("Unable to write file " + path);
+    }
+    ModelPtr model = game.getModel();
+    Implementation::FrameWriter writer(
+        file,
+        model->getWidth(),
+        model->getHeight(),
+        full_frame_interval
+    );
+    writer.write(*model, game.getMoveNumber());
+    int played = 0;
+    while ((played < moves) && !game.isOver()) {
+        game.step();
+        writer.write(*model, game.getMoveNumber());
+        played++;
+    }
+    return played;
+}
+
+static Implementation::GameMap readMap(
+    const Strings& scripts,
+    const std::string& map_path
+) {
+    std::ifstream file(map_path.c_str());
+    if (!file) {
+        throw Exception("Unable to read file " + map_path);
+    }
+    Implementation::GameMap map;
+    readYamlMap(file, map);
+    if (map.teams != scripts.size()) {
+        throw Exception("Number of scripts differs from teams of map");
+    }
+    return map;
+}
+
+static Implementation::Game* newGame(
+    const Strings& scripts,
+    const Implementation::GameParams& params,
+    const std::string& map_path
+) {
+    if (map_path.empty()) {
+        return new Implementation::Game(scripts, params);
+    }
+    Implementation::GameMap map = readMap(scripts, map_path);
+    return new Implementation::Game(
+        scripts,
+        map.getParams(params.trusted),
+        map.bacteria
+    );
+}
+
+static void runSingle(
+    const Strings& files,
+    const Strings& scripts,
+    const Implementation::GameParams& params,
+    int moves,
+    const std::string& frames,
+    int full_frame_interval,
+    const std::string& map,
+    const std::string& result,
+    bool profile,
+    bool memory
+) {
+    std::unique_ptr<Implementation::Game> game_ptr(
+        newGame(scripts, params, map)
+    );
+    Implementation::Game& game = *game_ptr;
+    Implementation::InstructionProfile instruction_profile;
+    if (profile) {
+        game.setProfile(&instruction_profile);
+    }
+    Clock::time_point start = Clock::now();
+    int played;
+    if (frames.empty()) {
+        played = game.run(moves);
+    } else {
+        played = playWithFrames(game, moves, frames, full_frame_interval);
+    }
+    std::chrono::duration<double> time = Clock::now() - start;
+    if (Metrics::isActive()) {
+        Metrics::addGame();
+    }
+    printGame(game, files);
+    std::cout << "time: " << time.count() << " s, moves/sec: "
+              << (played / time.count()) << std::endl;
+    if (profile) {
+        for (int team = 0; team < scripts.size(); team++) {
+            std::cout << files[team] << ":" << std::endl;
+            writeProfileReport(
+                std::cout,
+                instruction_profile,
+                team,
+                scripts[team]
+            );
+        }
+    }
+    if (memory) {
+        writeMemoryReport(std::cout, game.getMemoryReport());
+    }
+    if (!result.empty()) {
+        std::ofstream file(result.c_str());
+        writeYamlResult(file, game);
+        if (!file) {
+            throw Exception("Unable to write file " + result);
+        }
+    }
+}
+
+static void recordGame(
+    const Strings& files,
+    const Strings& scripts,
+    const Implementation::GameParams& params,
+    int moves,
+    const std::string& path,
+    int keyframe_interval,
+    const std::string& map_path
+) {
+    Implementation::GameParams game_params = params;
+    UnitList bacteria;
+    if (!map_path.empty()) {
+        Implementation::GameMap map = readMap(scripts, map_path);
+        game_params = map.getParams(params.trusted);
+        bacteria = map.bacteria;
+    }
+    Implementation::ReplayRecorder recorder(
+        scripts,
+        game_params,
+        keyframe_interval,
+        bacteria
+    );
+    recorder.run(moves);
+    printGame(recorder.getGame(), files);
+    writeFile(path, recorder.getReplay().serialize());
+    std::cout << "replay: " << path << std::endl;
+}
+
+static int playReplay(const std::string& path, int seek, bool verify) {
+    Implementation::Replay replay =
+        Implementation::Replay::make(readFile(path));
+    Implementation::ReplayPlayer player(replay);
+    if (verify) {
+        int mismatch = player.verify();
+        if (mismatch != -1) {
+            std::cout << "replay differs from the record after move "
+                      << mismatch << std::endl;
+            return 1;
+        }
+        std::cout << "replay verified: " << replay.getMovesNumber()
+                  << " moves" << std::endl;
+    }
+    if (seek < 0) {
+        seek = replay.getMovesNumber();
+    }
+    player.seek(seek);
+    Strings names;
+    for (int team = 0; team < replay.scripts.size(); team++) {
+        names.push_back("replay");
+    }
+    printGame(player.getGame(), names);
+    return 0;
+}
+
+static void showFrame(const std::string& path, int seek) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        throw Exception("Unable to read file " + path);
+    }
+    Implementation::FrameReader reader(file);
+    int frames = reader.getFramesNumber();
+    int index = frames - 1;
+    if (seek >= 0) {
+        // the first frame with the move
+        index = 0;
+        while ((index < frames - 1) && (reader.getMove(index) < seek)) {
+            index++;
+        }
+    }
+    const Implementation::Frame& frame = reader.read(index);
+    std::cout << "frames: " << frames << ", move: " << frame.move
+              << std::endl;
+    // '.' is empty cell, bacteria are shown by letters of teams
+    for (int y = 0; y < frame.height; y++) {
+        for (int x = 0; x < frame.width; x++) {
+            int team = frame.getCell(x, y).team;
+            std::cout << ((team < 0) ? '.' : char('a' + team % 26));
+        }
+        std::cout << std::endl;
+    }
+}
+
+static Implementation::BatchJobs readJobs(
+    const std::string& path,
+    bool trusted
+) {
+    std::istringstream jobs_file(readFile(path));
+    // every script file is read once
+    std::map<std::string, std::string> sources;
+    Implementation::BatchJobs jobs;
+    std::string line;
+    while (std::getline(jobs_file, line)) {
+        std::istringstream fields(line);
+        Implementation::BatchJob job;
+        Implementation::GameParams& params = job.params;
+        params.trusted = trusted;
+        if (!(fields >> params.width)) {
+            // empty line
+            continue;
+        }
+        if (!(fields >> params.height >> params.bacteria >>
+                params.seed >> job.moves)) {
+            throw Exception("Invalid job: " + line);
+        }
+        std::string file;
+        while (fields >> file) {
+            if (sources.find(file) == sources.end()) {
+                sources[file] = readFile(file);
+            }
+            job.scripts.push_back(sources[file]);
+        }
+        if (job.scripts.empty()) {
+            throw Exception("No scripts in job: " + line);
+        }
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+static void runBatch(
+    const std::string& path,
+    bool trusted,
+    int threads
+) {
+    Implementation::BatchJobs jobs = readJobs(path, trusted);
+    Implementation::BatchRunner runner(threads);
+    Clock::time_point start = Clock::now();
+    Implementation::BatchResults results = runner.run(jobs);
+    std::chrono::duration<double> time = Clock::now() - start;
+    long long total_moves = 0;
+    for (int i = 0; i < results.size(); i++) {
+        const Implementation::BatchResult& result = results[i];
+        total_moves += result.moves;
+        std::cout << "job " << i << ": moves " << result.moves
+                  << ", winner " << result.winner;
+        for (int team = 0; team < result.bacteria.size(); team++) {
+            std::cout << ", team " << team << " bacteria "
+                      << result.bacteria[team] << " mass "
+                      << result.masses[team];
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "threads: " << runner.getThreadsNumber()
+              << ", games: " << results.size()
+              << ", time: " << time.count() << " s" << std::endl;
+    std::cout << "games/sec: " << (results.size() / time.count())
+              << ", moves/sec: " << (total_moves / time.count())
+              << std::endl;
+}
+
+static void runTournament(
+    const Strings& files,
+    const Strings& scripts,
+    const Implementation::TournamentParams& params,
+    int threads
+) {
+    Implementation::Tournament tournament(scripts, params);
+    Implementation::BatchRunner runner(threads);
+    int games = tournament.getJobs().size();
+    Clock::time_point start = Clock::now();
+    tournament.run(runner);
+    std::chrono::duration<double> time = Clock::now() - start;
+    Ints ranking = tournament.getRanking();
+    std::cout << "rank\tgames\twins\tlosses\tdraws\tsurvived\tmass"
+              << "\tscript" << std::endl;
+    for (int i = 0; i < ranking.size(); i++) {
+        int script = ranking[i];
+        const Implementation::TournamentScore& score =
+            tournament.getScore(script);
+        std::cout << (i + 1) << "\t" << score.games
+                  << "\t" << score.wins << "\t" << score.losses
+                  << "\t" << score.draws << "\t" << score.survived
+                  << "\t" << score.mass << "\t" << files[script]
+                  << std::endl;
+    }
+    std::cout << "threads: " << runner.getThreadsNumber()
+              << ", games: " << games
+              << ", time: " << time.count() << " s"
+              << ", games/sec: " << (games / time.count()) << std::endl;
+}
+
+static void runEvolution(
+    const Strings& scripts,
+    const Implementation::EvolutionParams& params,
+    int generations,
+    int threads
+) {
+    // given scripts are both the first generation and the opponents
+    Implementation::Evolution evolution(scripts, scripts, params);
+    Implementation::BatchRunner runner(threads);
+    Clock::time_point start = Clock::now();
+    evolution.run(runner, generations,
+    [&](int generation, const Implementation::Individual& best) {
+        std::cout << "generation " << generation << ": fitness "
+                  << best.fitness << ", games "
+                  << evolution.getPlayedGames() << std::endl;
+    });
+    std::chrono::duration<double> time = Clock::now() - start;
+    std::cout << "threads: " << runner.getThreadsNumber()
+              << ", time: " << time.count() << " s, games/sec: "
+              << (evolution.getPlayedGames() / time.count())
+              << std::endl;
+    std::cout << "best script:" << std::endl
+              << evolution.getBest().script;
+}
+
+// random cases of 2, 3 and 4 teams with seeds seed, seed + 1, ...
+static int runLockstep(
+    const Implementation::GameParams& params,
+    int moves,
+    int games
+) {
+    for (int i = 0; i < games; i++) {
+        unsigned int seed = params.seed + i;
+        int teams = 2 + i % 3;
+        Implementation::LockstepCase lockstep_case =
+            Implementation::makeLockstepCase(
+                seed,
+                params.width,
+                params.height,
+                teams,
+                params.bacteria
+            );
+        Implementation::LockstepChecker checker(
+            lockstep_case.scripts,
+            lockstep_case.map,
+            Implementation::makeCheckedEngine,
+            Implementation::makeTrustedEngine
+        );
+        Implementation::Divergence divergence = checker.run(moves);
+        if (divergence.found()) {
+            std::cout << "game " << i << " (seed " << seed << ", teams "
+                      << teams << "): engines differ after move "
+                      << divergence.move << ", team " << divergence.team
+                      << ", bacterium " << divergence.bacterium
+                      << ", command '" << divergence.command << "'"
+                      << std::endl << divergence.description << std::endl;
+            for (int team = 0; team < teams; team++) {
+                std::cout << "script of team " << team << ":" << std::endl
+                          << lockstep_case.scripts[team];
+            }
+            return 1;
+        }
+        std::cout << "game " << i << " (seed " << seed << ", teams "
+                  << teams << "): " << checker.getMoveNumber()
+                  << " moves equal" << std::endl;
+    }
+    return 0;
+}
+
+static void writeTrace(const std::string& path) {
+    std::ofstream file(path.c_str());
+    Trace::write(file);
+    if (!file) {
+        throw Exception("Unable to write file " + path);
+    }
+    std::cout << "trace: " << path << ", events: "
+              << Trace::getEventsNumber() << std::endl;
+    if (Trace::getDroppedEvents() > 0) {
+        std::cout << "dropped events: " << Trace::getDroppedEvents()
+                  << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    Implementation::GameParams params(20, 20, 5);
+    int moves = DEFAULT_MOVES;
+    Strings files;
+    Strings scripts;
+    std::string batch;
+    int threads = 0;
+    bool tournament = false;
+    Implementation::TournamentParams tournament_params;
+    std::string record;
+    int keyframe_interval = Implementation::DEFAULT_KEYFRAME_INTERVAL;
+    std::string replay;
+    int seek = -1;
+    bool verify = false;
+    std::string frames;
+    int full_frame_interval = Implementation::DEFAULT_FULL_FRAME_INTERVAL;
+    std::string show_frames;
+    std::string map;
+    std::string result;
+    int generations = 0;
+    int population = Implementation::EvolutionParams().population;
+    bool counters = false;
+    std::string trace;
+    bool profile = false;
+    bool memory = false;
+    int lockstep = 0;
+    int metrics_port = -1;
+    int status = 0;
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--width") {
+                params.width = intArgument(argc, argv, i);
+            } else if (arg == "--height") {
+                params.height = intArgument(argc, argv, i);
+            } else if (arg == "--bacteria") {
+                params.bacteria = intArgument(argc, argv, i);
+            } else if (arg == "--moves") {
+                moves = intArgument(argc, argv, i);
+            } else if (arg == "--seed") {
+                params.seed = intArgument(argc, argv, i);
+            } else if (arg == "--trusted") {
+                params.trusted = true;
+            } else if (arg == "--batch") {
+                batch = stringArgument(argc, argv, i);
+            } else if (arg == "--threads") {
+                threads = intArgument(argc, argv, i);
+            } else if (arg == "--tournament") {
+                tournament = true;
+            } else if (arg == "--seeds") {
+                tournament_params.seeds = intArgument(argc, argv, i);
+            } else if (arg == "--ffa") {
+                tournament_params.free_for_all = intArgument(argc, argv, i);
+            } else if (arg == "--evolve") {
+                generations = intArgument(argc, argv, i);
+            } else if (arg == "--population") {
+                population = intArgument(argc, argv, i);
+            } else if (arg == "--record") {
+                record = stringArgument(argc, argv, i);
+            } else if (arg == "--keyframe-interval") {
+                keyframe_interval = intArgument(argc, argv, i);
+            } else if (arg == "--replay") {
+                replay = stringArgument(argc, argv, i);
+            } else if (arg == "--seek") {
+                seek = intArgument(argc, argv, i);
+            } else if (arg == "--verify") {
+                verify = true;
+            } else if (arg == "--frames") {
+                frames = stringArgument(argc, argv, i);
+            } else if (arg == "--full-frame-interval") {
+                full_frame_interval = intArgument(argc, argv, i);
+            } else if (arg == "--show-frames") {
+                show_frames = stringArgument(argc, argv, i);
+            } else if (arg == "--map") {
+                map = stringArgument(argc, argv, i);
+            } else if (arg == "--result") {
+                result = stringArgument(argc, argv, i);
+            } else if (arg == "--trace") {
+                trace = stringArgument(argc, argv, i);
+            } else if (arg == "--profile") {
+                profile = true;
+            } else if (arg == "--memory") {
+                memory = true;
+            } else if (arg == "--lockstep") {
+                lockstep = intArgument(argc, argv, i);
+            } else if (arg == "--metrics-port") {
+                metrics_port = intArgument(argc, argv, i);
+            } else if (arg == "--counters") {
+                counters = true;
+            } else if (arg == "--help") {
+                usage();
+                return 0;
+            } else if (arg.compare(0, 2, "--") == 0) {
+                throw Exception("Unknown option " + arg);
+            } else {
+                files.push_back(arg);
+                scripts.push_back(readFile(arg));
+            }
+        }
+        if (counters && !Counters::isEnabled()) {
+            throw Exception("bacteria-run is built without counters");
+        }
+        if (!record.empty() && (!frames.empty() || !result.empty())) {
+            throw Exception("--record can not be used with --frames"
+                            " or --result");
+        }
+        Counters::Values counters_start = Counters::getCounters();
+        if (!trace.empty()) {
+            Trace::start();
+        }
+        std::unique_ptr<Metrics::Server> metrics_server;
+        if (metrics_port >= 0) {
+            metrics_server.reset(new Metrics::Server(metrics_port));
+            std::cout << "metrics: http://127.0.0.1:"
+                      << metrics_server->getPort() << "/metrics"
+                      << std::endl;
+        }
+        if (!replay.empty()) {
+            status = playReplay(replay, seek, verify);
+        } else if (!show_frames.empty()) {
+            showFrame(show_frames, seek);
+        } else if (lockstep > 0) {
+            status = runLockstep(params, moves, lockstep);
+        } else if (!batch.empty()) {
+            runBatch(batch, params.trusted, threads);
+        } else if (scripts.empty()) {
+            usage();
+            return 1;
+        } else if (tournament) {
+            tournament_params.game = params;
+            tournament_params.moves = moves;
+            runTournament(files, scripts, tournament_params, threads);
+        } else if (generations > 0) {
+            Implementation::EvolutionParams evolution_params(
+                params,
+                tournament_params.seeds,
+                moves,
+                population
+            );
+            evolution_params.seed = params.seed;
+            runEvolution(scripts, evolution_params, generations, threads);
+        } else if (!record.empty()) {
+            recordGame(
+                files,
+                scripts,
+                params,
+                moves,
+                record,
+                keyframe_interval,
+                map
+            );
+        } else {
+            runSingle(
+                files,
+                scripts,
+                params,
+                moves,
+                frames,
+                full_frame_interval,
+                map,
+                result,
+                profile,
+                memory
+            );
+        }
+        if (!trace.empty()) {
+            Trace::stop();
+            writeTrace(trace);
+        }
+        if (counters) {
+            std::cout << "counters:" << std::endl;
+            Counters::print(
+                std::cout,
+                Counters::getCounters() - counters_start
+            );
+        }
+    } catch (std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return status;
+}
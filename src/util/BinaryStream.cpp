@@ -0,0 +1,127 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include "BinaryStream.hpp"
+#include "Exception.hpp"
+
+BinaryWriter::BinaryWriter(std::string& data)
+    : data_(data) {
+}
+
+void BinaryWriter::writeUint(uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; i++) {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+    data_.append(bytes, 4);
+}
+
+void BinaryWriter::writeInt(int32_t value) {
+    writeUint(static_cast<uint32_t>(value));
+}
+
+void BinaryWriter::writeUint64(uint64_t value) {
+    writeUint(static_cast<uint32_t>(value));
+    writeUint(static_cast<uint32_t>(value >> 32));
+}
+
+void BinaryWriter::writeString(const std::string& value) {
+    writeUint(value.size());
+    data_.append(value);
+}
+
+void BinaryWriter::writeVarint(uint32_t value) {
+    while (value >= 0x80) {
+        data_.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    data_.push_back(static_cast<char>(value));
+}
+
+void BinaryWriter::writeSignedVarint(int32_t value) {
+    uint32_t zigzag = (static_cast<uint32_t>(value) << 1) ^
+                      static_cast<uint32_t>(value >> 31);
+    writeVarint(zigzag);
+}
+
+void BinaryWriter::writeBytes(const char* bytes, int size) {
+    data_.append(bytes, size);
+}
+
+BinaryReader::BinaryReader(const std::string& data)
+    : data_(data)
+    , position_(0) {
+}
+
+uint32_t BinaryReader::readUint() {
+    require(4);
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        unsigned char byte = data_[position_ + i];
+        value |= static_cast<uint32_t>(byte) << (8 * i);
+    }
+    position_ += 4;
+    return value;
+}
+
+int32_t BinaryReader::readInt() {
+    return static_cast<int32_t>(readUint());
+}
+
+uint64_t BinaryReader::readUint64() {
+    uint64_t low = readUint();
+    uint64_t high = readUint();
+    return low | (high << 32);
+}
+
+std::string BinaryReader::readString() {
+    uint32_t size = readUint();
+    require(size);
+    std::string value = data_.substr(position_, size);
+    position_ += size;
+    return value;
+}
+
+uint32_t BinaryReader::readVarint() {
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        require(1);
+        unsigned char byte = data_[position_];
+        position_++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw Exception("Binary data: invalid varint.");
+}
+
+int32_t BinaryReader::readSignedVarint() {
+    uint32_t zigzag = readVarint();
+    return static_cast<int32_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+}
+
+bool BinaryReader::readBytes(const char* bytes, int size) {
+    require(size);
+    bool equal = (data_.compare(position_, size, bytes, size) == 0);
+    position_ += size;
+    return equal;
+}
+
+bool BinaryReader::atEnd() const {
+    return position_ == data_.size();
+}
+
+int BinaryReader::getRemaining() const {
+    return data_.size() - position_;
+}
+
+void BinaryReader::require(uint32_t size) const {
+    if (data_.size() - position_ < size) {
+        throw Exception("Binary data is truncated.");
+    }
+}
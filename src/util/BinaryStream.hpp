@@ -0,0 +1,81 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef BINARY_STREAM_HPP_
+#define BINARY_STREAM_HPP_
+
+#include <string>
+#include <stdint.h>
+
+/** Writes numbers to a byte string (little-endian, fixed size) */
+class BinaryWriter {
+public:
+    /** Constructor
+    \param data String to append to
+    */
+    BinaryWriter(std::string& data);
+
+    void writeUint(uint32_t value);
+
+    void writeInt(int32_t value);
+
+    void writeUint64(uint64_t value);
+
+    /** Write size of the string and its bytes */
+    void writeString(const std::string& value);
+
+    /** Variable length: 7 bits per byte, small numbers take 1 byte */
+    void writeVarint(uint32_t value);
+
+    /** Variable length, zigzag encoding (small absolute values
+    take 1 byte) */
+    void writeSignedVarint(int32_t value);
+
+    void writeBytes(const char* bytes, int size);
+
+private:
+    std::string& data_;
+};
+
+/** Reads numbers written by BinaryWriter.
+Throws Exception if data is truncated.
+*/
+class BinaryReader {
+public:
+    /** Constructor
+    \param data Source data (must outlive the reader)
+    */
+    BinaryReader(const std::string& data);
+
+    uint32_t readUint();
+
+    int32_t readInt();
+
+    uint64_t readUint64();
+
+    std::string readString();
+
+    uint32_t readVarint();
+
+    int32_t readSignedVarint();
+
+    /** Return true if next bytes are equal to bytes (and skip them) */
+    bool readBytes(const char* bytes, int size);
+
+    bool atEnd() const;
+
+    /** Return the number of bytes which are not read yet */
+    int getRemaining() const;
+
+private:
+    const std::string& data_;
+    int position_;
+
+    void require(uint32_t size) const;
+};
+
+#endif
@@ -0,0 +1,159 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <atomic>
+
+#include "Counters.hpp"
+
+namespace Counters {
+
+static const char* const names[COUNTERS_NUMBER] = {
+    "command_eat",
+    "command_go",
+    "command_clon",
+    "command_str",
+    "command_left",
+    "command_right",
+    "command_back",
+    "command_turn",
+    "command_jg",
+    "command_jl",
+    "command_j",
+    "command_je",
+    "pseudo_action_penalties",
+    "deaths_go",
+    "deaths_clon",
+    "deaths_str",
+    "deaths_attacked",
+    "deaths_penalty",
+    "round_enemy_searches",
+    "team_moves",
+    "team_move_nanoseconds"
+};
+
+// Counters of one thread. Only the owner writes them, so relaxed
+// load and store are enough. Blocks are never freed: the block of
+// a finished thread keeps its values and is reused by a new thread.
+struct Block {
+    std::atomic<uint64_t> values[COUNTERS_NUMBER];
+    std::atomic<bool> used;
+    Block* next;
+};
+
+static std::atomic<Block*> blocks(NULL);
+
+static Block* acquireBlock() {
+    Block* head = blocks.load(std::memory_order_acquire);
+    for (Block* block = head; block != NULL; block = block->next) {
+        bool expected = false;
+        if (block->used.compare_exchange_strong(
+                expected,
+                true,
+                std::memory_order_acquire)) {
+            return block;
+        }
+    }
+    Block* block = new Block;
+    for (int i = 0; i < COUNTERS_NUMBER; i++) {
+        block->values[i].store(0, std::memory_order_relaxed);
+    }
+    block->used.store(true, std::memory_order_relaxed);
+    block->next = head;
+    while (!blocks.compare_exchange_weak(
+               block->next,
+               block,
+               std::memory_order_release)) {
+    }
+    return block;
+}
+
+// owns the block of the thread until the thread finishes
+class BlockOwner {
+public:
+    BlockOwner()
+        : block(acquireBlock()) {
+    }
+
+    ~BlockOwner() {
+        block->used.store(false, std::memory_order_release);
+    }
+
+    Block* block;
+};
+
+Values::Values() {
+    for (int i = 0; i < COUNTERS_NUMBER; i++) {
+        values[i] = 0;
+    }
+}
+
+Values Values::operator-(const Values& earlier) const {
+    Values result;
+    for (int i = 0; i < COUNTERS_NUMBER; i++) {
+        result.values[i] = values[i] - earlier.values[i];
+    }
+    return result;
+}
+
+bool isEnabled() {
+#ifdef BACTERIA_COUNTERS
+    return true;
+#else
+    return false;
+#endif
+}
+
+Values getCounters() {
+    Values result;
+    Block* block = blocks.load(std::memory_order_acquire);
+    for (; block != NULL; block = block->next) {
+        for (int i = 0; i < COUNTERS_NUMBER; i++) {
+            result.values[i] +=
+                block->values[i].load(std::memory_order_relaxed);
+        }
+    }
+    return result;
+}
+
+const char* getName(int counter) {
+    return names[counter];
+}
+
+void print(std::ostream& out, const Values& values) {
+    for (int i = 0; i < COUNTERS_NUMBER; i++) {
+        if (values[i] != 0) {
+            out << names[i] << " " << values[i] << std::endl;
+        }
+    }
+    if (values[TEAM_MOVES] != 0) {
+        out << "nanoseconds_per_team_move "
+            << (values[TEAM_MOVE_NANOSECONDS] / values[TEAM_MOVES])
+            << std::endl;
+    }
+}
+
+void add(int counter, uint64_t value) {
+    static thread_local BlockOwner owner;
+    std::atomic<uint64_t>& target = owner.block->values[counter];
+    target.store(
+        target.load(std::memory_order_relaxed) + value,
+        std::memory_order_relaxed
+    );
+}
+
+TeamMoveTimer::TeamMoveTimer()
+    : start_(std::chrono::steady_clock::now()) {
+}
+
+TeamMoveTimer::~TeamMoveTimer() {
+    std::chrono::nanoseconds time =
+        std::chrono::steady_clock::now() - start_;
+    add(TEAM_MOVES, 1);
+    add(TEAM_MOVE_NANOSECONDS, time.count());
+}
+
+}
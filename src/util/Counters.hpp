@@ -0,0 +1,109 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef COUNTERS_HPP_
+#define COUNTERS_HPP_
+
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+
+/** Counters of the hot path of the engine.
+
+Counting is compiled in only if BACTERIA_COUNTERS is defined
+(cmake -DBACTERIA_COUNTERS=ON); otherwise COUNTER_INC() and
+COUNTER_TEAM_MOVE() expand to nothing. Every thread increments
+its own block of counters, getCounters() sums the blocks of all
+threads, so games running in parallel never wait for each other.
+*/
+namespace Counters {
+
+enum Counter {
+    // executed instructions by command (in order of function ids
+    // of Bytecode)
+    COMMAND_EAT,
+    COMMAND_GO,
+    COMMAND_CLON,
+    COMMAND_STR,
+    COMMAND_LEFT,
+    COMMAND_RIGHT,
+    COMMAND_BACK,
+    COMMAND_TURN,
+    COMMAND_JG,
+    COMMAND_JL,
+    COMMAND_J,
+    COMMAND_JE,
+    // mass penalties for too many pseudo actions
+    PSEUDO_ACTION_PENALTIES,
+    // deaths by cause
+    DEATHS_GO,
+    DEATHS_CLON,
+    DEATHS_STR,
+    DEATHS_ATTACKED,
+    DEATHS_PENALTY,
+    ROUND_ENEMY_SEARCHES,
+    // moves of one team and their total wall time
+    TEAM_MOVES,
+    TEAM_MOVE_NANOSECONDS,
+    COUNTERS_NUMBER
+};
+
+/** Values of all counters */
+struct Values {
+    Values();
+
+    uint64_t values[COUNTERS_NUMBER];
+
+    uint64_t operator[](int counter) const {
+        return values[counter];
+    }
+
+    /** Return the increase of counters since the earlier values */
+    Values operator-(const Values& earlier) const;
+};
+
+/** Return true if counting is compiled in */
+bool isEnabled();
+
+/** Return the sum of counters of all threads.
+Counters are never reset; subtract values taken before the
+measured interval.
+*/
+Values getCounters();
+
+/** Return the name of the counter */
+const char* getName(int counter);
+
+/** Print non-zero counters, one per line */
+void print(std::ostream& out, const Values& values);
+
+/** Add to the counter of the calling thread */
+void add(int counter, uint64_t value);
+
+/** Add wall time of the scope to TEAM_MOVE_NANOSECONDS
+and count TEAM_MOVES */
+class TeamMoveTimer {
+public:
+    TeamMoveTimer();
+
+    ~TeamMoveTimer();
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+}
+
+#ifdef BACTERIA_COUNTERS
+#define COUNTER_INC(counter) Counters::add((counter), 1)
+#define COUNTER_TEAM_MOVE() Counters::TeamMoveTimer team_move_timer_
+#else
+#define COUNTER_INC(counter) ((void) 0)
+#define COUNTER_TEAM_MOVE() ((void) 0)
+#endif
+
+#endif
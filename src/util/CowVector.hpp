@@ -0,0 +1,149 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef COW_VECTOR_HPP_
+#define COW_VECTOR_HPP_
+
+#include <memory>
+#include <vector>
+
+/** Vector with copy-on-write chunks.
+
+Elements are stored in chunks of CHUNK_SIZE elements.
+Copy of a CowVector shares all chunks with the original;
+a chunk is copied when it is changed by one of the copies
+while others still refer to it. Reading is done through
+operator[], changing through edit().
+
+A CowVector and all its copies must be used by one thread:
+whether a chunk is shared is decided by use_count() of the chunk,
+which does not synchronize with other threads.
+*/
+template<typename T>
+class CowVector {
+public:
+    static const int CHUNK_BITS = 10;
+    static const int CHUNK_SIZE = 1 << CHUNK_BITS;
+
+    CowVector()
+        : size_(0) {
+    }
+
+    int size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    const T& operator[](int index) const {
+        return data_[index >> CHUNK_BITS][index & (CHUNK_SIZE - 1)];
+    }
+
+    /** Return changeable element (copies its chunk if it is shared) */
+    T& edit(int index) {
+        int chunk = index >> CHUNK_BITS;
+        if (chunks_[chunk].use_count() > 1) {
+            detach(chunk);
+        }
+        return data_[chunk][index & (CHUNK_SIZE - 1)];
+    }
+
+    const T& back() const {
+        return (*this)[size_ - 1];
+    }
+
+    void push_back(const T& value) {
+        if ((size_ & (CHUNK_SIZE - 1)) == 0) {
+            int chunk = size_ >> CHUNK_BITS;
+            if (chunk == chunks_.size()) {
+                chunks_.push_back(ChunkPtr(new Chunk(CHUNK_SIZE)));
+                data_.push_back(&(*chunks_.back())[0]);
+            }
+        }
+        size_++;
+        edit(size_ - 1) = value;
+    }
+
+    void pop_back() {
+        size_--;
+    }
+
+    /** Change size; new elements are equal to value.
+    Memory of removed elements is kept (if it is not shared).
+    */
+    void resize(int size, const T& value = T()) {
+        int old_size = size_;
+        int chunks = (size + CHUNK_SIZE - 1) >> CHUNK_BITS;
+        while (chunks_.size() < chunks) {
+            chunks_.push_back(ChunkPtr(new Chunk(CHUNK_SIZE)));
+            data_.push_back(&(*chunks_.back())[0]);
+        }
+        size_ = size;
+        for (int i = old_size; i < size; i++) {
+            edit(i) = value;
+        }
+    }
+
+    void assign(int size, const T& value) {
+        clear();
+        resize(size, value);
+    }
+
+    void clear() {
+        // shared chunks are released, own chunks are kept for reuse
+        int own = 0;
+        for (int i = 0; i < chunks_.size(); i++) {
+            if (chunks_[i].use_count() == 1) {
+                chunks_[own] = chunks_[i];
+                data_[own] = data_[i];
+                own++;
+            }
+        }
+        chunks_.resize(own);
+        data_.resize(own);
+        size_ = 0;
+    }
+
+    /** Return heap memory used by the vector (bytes),
+    shared chunks are counted too
+    */
+    long long getMemoryUsage() const {
+        long long chunk = sizeof(Chunk) + CHUNK_SIZE * sizeof(T);
+        return chunks_.size() * chunk +
+               chunks_.capacity() * sizeof(ChunkPtr) +
+               data_.capacity() * sizeof(T*);
+    }
+
+    /** Return number of chunks which are shared with other copies */
+    int sharedChunks() const {
+        int shared = 0;
+        for (int i = 0; i < chunks_.size(); i++) {
+            if (chunks_[i].use_count() > 1) {
+                shared++;
+            }
+        }
+        return shared;
+    }
+
+private:
+    typedef std::vector<T> Chunk;
+    typedef std::shared_ptr<Chunk> ChunkPtr;
+
+    std::vector<ChunkPtr> chunks_;
+    // data_[i] is the first element of chunks_[i]
+    std::vector<T*> data_;
+    int size_;
+
+    void detach(int chunk) {
+        chunks_[chunk] = ChunkPtr(new Chunk(*chunks_[chunk]));
+        data_[chunk] = &(*chunks_[chunk])[0];
+    }
+};
+
+#endif
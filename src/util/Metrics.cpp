@@ -0,0 +1,289 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "Metrics.hpp"
+#include "Exception.hpp"
+
+namespace Metrics {
+
+std::atomic<int> servers(0);
+
+static std::atomic<long long> moves(0);
+static std::atomic<long long> games(0);
+static std::atomic<long long> cache_hits(0);
+static std::atomic<long long> cache_misses(0);
+static std::atomic<int> teams(0);
+static std::atomic<int> live_bacteria[MAX_TEAMS];
+
+// maximum time of waiting for a client before checking
+// the stop flag and sampling moves/sec
+static const int POLL_TIMEOUT_MS = 100;
+
+// maximum size of a request and time of receiving the whole request
+// (moves/sec is not sampled while a client is served)
+static const int MAX_REQUEST = 4096;
+static const int RECEIVE_TIMEOUT_MS = 500;
+
+void addMove() {
+    moves.fetch_add(1, std::memory_order_relaxed);
+}
+
+LiveBacteria::LiveBacteria() {
+}
+
+LiveBacteria::~LiveBacteria() {
+    for (int team = 0; team < bacteria_.size(); team++) {
+        set(team, 0);
+    }
+}
+
+void LiveBacteria::set(int team, int bacteria) {
+    if (team >= MAX_TEAMS) {
+        return;
+    }
+    if (team >= bacteria_.size()) {
+        bacteria_.resize(team + 1, 0);
+        // gauges are written for teams below the maximum
+        int known = teams.load(std::memory_order_relaxed);
+        while ((known <= team) &&
+                !teams.compare_exchange_weak(known, team + 1)) {
+            // known is reloaded by the failed exchange
+        }
+    }
+    int change = bacteria - bacteria_[team];
+    if (change != 0) {
+        live_bacteria[team].fetch_add(change, std::memory_order_relaxed);
+        bacteria_[team] = bacteria;
+    }
+}
+
+void addGame() {
+    games.fetch_add(1, std::memory_order_relaxed);
+}
+
+void addCacheLookup(bool hit) {
+    if (hit) {
+        cache_hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        cache_misses.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+long long getRss() {
+    // second field of statm is resident pages
+    std::ifstream statm("/proc/self/statm");
+    long long size = 0, resident = 0;
+    if (!(statm >> size >> resident)) {
+        return 0;
+    }
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+static void writeMetric(
+    std::ostream& out,
+    const char* name,
+    const char* type,
+    const char* help
+) {
+    out << "# HELP " << name << " " << help << "\n"
+        << "# TYPE " << name << " " << type << "\n";
+}
+
+void write(std::ostream& out, double moves_per_second) {
+    long long hits = cache_hits.load(std::memory_order_relaxed);
+    long long misses = cache_misses.load(std::memory_order_relaxed);
+    writeMetric(out, "bacteria_moves_total", "counter",
+                "Moves played by all games.");
+    out << "bacteria_moves_total "
+        << moves.load(std::memory_order_relaxed) << "\n";
+    writeMetric(out, "bacteria_moves_per_second", "gauge",
+                "Moves per second in the last sampling interval.");
+    out << "bacteria_moves_per_second " << moves_per_second << "\n";
+    writeMetric(out, "bacteria_games_completed_total", "counter",
+                "Finished games.");
+    out << "bacteria_games_completed_total "
+        << games.load(std::memory_order_relaxed) << "\n";
+    writeMetric(out, "bacteria_live_bacteria", "gauge",
+                "Live bacteria of teams in all existing games.");
+    int teams_number = teams.load(std::memory_order_relaxed);
+    for (int team = 0; (team < teams_number) && (team < MAX_TEAMS);
+            team++) {
+        out << "bacteria_live_bacteria{team=\"" << team << "\"} "
+            << live_bacteria[team].load(std::memory_order_relaxed)
+            << "\n";
+    }
+    writeMetric(out, "bacteria_bytecode_cache_hits_total", "counter",
+                "Scripts found in bytecode cache.");
+    out << "bacteria_bytecode_cache_hits_total " << hits << "\n";
+    writeMetric(out, "bacteria_bytecode_cache_misses_total", "counter",
+                "Scripts compiled by bytecode cache.");
+    out << "bacteria_bytecode_cache_misses_total " << misses << "\n";
+    writeMetric(out, "bacteria_bytecode_cache_hit_ratio", "gauge",
+                "Share of lookups found in bytecode cache.");
+    out << "bacteria_bytecode_cache_hit_ratio "
+        << ((hits + misses == 0) ? 0.0 : double(hits) / (hits + misses))
+        << "\n";
+    writeMetric(out, "bacteria_resident_memory_bytes", "gauge",
+                "Resident set size of the process.");
+    out << "bacteria_resident_memory_bytes " << getRss() << "\n";
+}
+
+Server::Server(int port, int rate_interval_ms)
+    : socket_(-1)
+    , port_(port)
+    , rate_interval_(rate_interval_ms)
+    , stop_(false)
+    , last_moves_(moves.load(std::memory_order_relaxed))
+    , last_time_(Clock::now())
+    , moves_per_second_(0) {
+    if (rate_interval_ms <= 0) {
+        throw Exception("Metrics: sampling interval must be positive.");
+    }
+    socket_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (socket_ < 0) {
+        throw Exception("Metrics: unable to create socket.");
+    }
+    int reuse = 1;
+    setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    socklen_t length = sizeof(address);
+    if ((bind(socket_, (sockaddr*)&address, length) != 0) ||
+            (listen(socket_, SOMAXCONN) != 0) ||
+            (getsockname(socket_, (sockaddr*)&address, &length) != 0)) {
+        close(socket_);
+        std::ostringstream message;
+        message << "Metrics: unable to listen on port " << port << ".";
+        throw Exception(message.str());
+    }
+    port_ = ntohs(address.sin_port);
+    thread_ = std::thread(&Server::serve, this);
+    servers++;
+}
+
+Server::~Server() {
+    stop_ = true;
+    thread_.join();
+    close(socket_);
+    servers--;
+}
+
+int Server::getPort() const {
+    return port_;
+}
+
+void Server::serve() {
+    int timeout = POLL_TIMEOUT_MS;
+    if (rate_interval_.count() < timeout) {
+        timeout = rate_interval_.count();
+    }
+    while (!stop_) {
+        pollfd listener;
+        listener.fd = socket_;
+        listener.events = POLLIN;
+        int ready = poll(&listener, 1, timeout);
+        sampleRate();
+        if (ready <= 0) {
+            continue;
+        }
+        int client = accept(socket_, NULL, NULL);
+        if (client >= 0) {
+            answer(client);
+            close(client);
+        }
+    }
+}
+
+void Server::sampleRate() {
+    Clock::time_point now = Clock::now();
+    if (now - last_time_ < rate_interval_) {
+        return;
+    }
+    long long current_moves = moves.load(std::memory_order_relaxed);
+    std::chrono::duration<double> time = now - last_time_;
+    moves_per_second_ = (current_moves - last_moves_) / time.count();
+    last_moves_ = current_moves;
+    last_time_ = now;
+}
+
+static void sendAll(int client, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t result = send(
+            client,
+            data.data() + sent,
+            data.size() - sent,
+            MSG_NOSIGNAL
+        );
+        if (result <= 0) {
+            return;
+        }
+        sent += result;
+    }
+}
+
+void Server::answer(int client) {
+    Clock::time_point deadline =
+        Clock::now() + std::chrono::milliseconds(RECEIVE_TIMEOUT_MS);
+    std::string request;
+    char buffer[512];
+    while ((request.find("\r\n\r\n") == std::string::npos) &&
+            (request.size() < MAX_REQUEST)) {
+        long long remaining =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - Clock::now()
+            ).count();
+        if (remaining <= 0) {
+            break;
+        }
+        pollfd input;
+        input.fd = client;
+        input.events = POLLIN;
+        if (poll(&input, 1, remaining) <= 0) {
+            break;
+        }
+        ssize_t received = recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        request.append(buffer, received);
+    }
+    std::string body;
+    std::string status;
+    if ((request.compare(0, 13, "GET /metrics ") == 0) ||
+            (request.compare(0, 6, "GET / ") == 0)) {
+        std::ostringstream out;
+        write(out, moves_per_second_);
+        body = out.str();
+        status = "200 OK";
+    } else {
+        body = "Not found\n";
+        status = "404 Not Found";
+    }
+    std::ostringstream response;
+    response << "HTTP/1.0 " << status << "\r\n"
+             << "Content-Type: text/plain; version=0.0.4\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    sendAll(client, response.str());
+}
+
+}
@@ -0,0 +1,123 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef METRICS_HPP_
+#define METRICS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+/** Live metrics of long simulations in Prometheus text format.
+
+The engine publishes values with relaxed atomic operations while
+metrics are active (see Server), otherwise publishing costs one
+relaxed load of a counter. Values are read by the thread of the server,
+simulation threads never wait for it.
+Live bacteria of a team are summed over existing games
+(see LiveBacteria), so parallel games do not overwrite each other.
+*/
+namespace Metrics {
+
+/** Maximum number of teams with own live bacteria gauge */
+const int MAX_TEAMS = 64;
+
+/** Default interval of sampling of moves/sec (milliseconds) */
+const int DEFAULT_RATE_INTERVAL_MS = 1000;
+
+// number of existing servers
+extern std::atomic<int> servers;
+
+inline bool isActive() {
+    return servers.load(std::memory_order_relaxed) > 0;
+}
+
+/** Count a played move (called by Game) */
+void addMove();
+
+/** Contribution of one game to the gauges of live bacteria.
+It starts without contribution (a fork of a game is counted
+after its first move), the destructor removes the contribution.
+*/
+class LiveBacteria {
+public:
+    LiveBacteria();
+
+    ~LiveBacteria();
+
+    /** Set the number of live bacteria of the team in the game */
+    void set(int team, int bacteria);
+
+private:
+    // published numbers of teams
+    std::vector<int> bacteria_;
+
+    LiveBacteria(const LiveBacteria&);
+
+    LiveBacteria& operator=(const LiveBacteria&);
+};
+
+/** Count a finished game */
+void addGame();
+
+/** Count a lookup in BytecodeCache */
+void addCacheLookup(bool hit);
+
+/** Return resident set size of the process (bytes) */
+long long getRss();
+
+/** Write metrics in Prometheus text format
+\param moves_per_second Value of the moves/sec gauge
+*/
+void write(std::ostream& out, double moves_per_second);
+
+/** HTTP server of metrics on 127.0.0.1 (GET /metrics).
+Metrics are active while any server exists.
+Moves/sec is sampled by the thread of the server on a fixed
+interval, so it does not depend on requests and their clients.
+*/
+class Server {
+public:
+    /** Constructor
+    \param port TCP port (0 means any free port, see getPort)
+    \param rate_interval_ms Interval of sampling of moves/sec
+    */
+    Server(int port, int rate_interval_ms = DEFAULT_RATE_INTERVAL_MS);
+
+    ~Server();
+
+    int getPort() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    int socket_;
+    int port_;
+    std::chrono::milliseconds rate_interval_;
+    std::atomic<bool> stop_;
+    std::thread thread_;
+    // the last sample of moves (used by the thread of the server)
+    long long last_moves_;
+    Clock::time_point last_time_;
+    double moves_per_second_;
+
+    Server(const Server&);
+
+    Server& operator=(const Server&);
+
+    void serve();
+
+    void sampleRate();
+
+    void answer(int client);
+};
+
+}
+
+#endif
@@ -0,0 +1,36 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef PLAIN_VECTOR_HPP_
+#define PLAIN_VECTOR_HPP_
+
+#include <vector>
+
+/** std::vector with the interface of CowVector.
+
+Copies do not share memory, elements are accessed directly
+(without indirection through chunks).
+*/
+template<typename T>
+class PlainVector : public std::vector<T> {
+public:
+    int size() const {
+        return std::vector<T>::size();
+    }
+
+    /** Return changeable element */
+    T& edit(int index) {
+        return (*this)[index];
+    }
+
+    /** Return heap memory used by the vector (bytes) */
+    long long getMemoryUsage() const {
+        return std::vector<T>::capacity() * sizeof(T);
+    }
+};
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Trace.hpp"
+#include "Exception.hpp"
+
+namespace Trace {
+
+std::atomic<bool> active(false);
+
+struct Event {
+    const char* name;
+    int arg;
+    Clock::time_point start;
+    Clock::time_point end;
+};
+
+// events of one thread, only the thread writes them
+struct ThreadBuffer {
+    int tid;
+    long long dropped;
+    std::vector<Event> events;
+};
+
+typedef std::vector<std::unique_ptr<ThreadBuffer> > ThreadBuffers;
+
+// buffers of all threads which recorded events (never removed),
+// the mutex is locked only when a thread records its first event
+static std::mutex buffers_mutex;
+static ThreadBuffers buffers;
+static Clock::time_point trace_start;
+
+static ThreadBuffer* getThreadBuffer() {
+    static thread_local ThreadBuffer* buffer = NULL;
+    if (buffer == NULL) {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer));
+        buffer = buffers.back().get();
+        buffer->tid = buffers.size();
+        buffer->dropped = 0;
+    }
+    return buffer;
+}
+
+void start() {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    for (int i = 0; i < buffers.size(); i++) {
+        buffers[i]->events.clear();
+        buffers[i]->dropped = 0;
+    }
+    trace_start = Clock::now();
+    active.store(true, std::memory_order_release);
+}
+
+void stop() {
+    active.store(false, std::memory_order_release);
+}
+
+static void checkStopped() {
+    if (isActive()) {
+        throw Exception("Trace: recorded events are read while "
+                        "tracing is active.");
+    }
+}
+
+long long getEventsNumber() {
+    checkStopped();
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    long long events = 0;
+    for (int i = 0; i < buffers.size(); i++) {
+        events += buffers[i]->events.size();
+    }
+    return events;
+}
+
+long long getDroppedEvents() {
+    checkStopped();
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    long long dropped = 0;
+    for (int i = 0; i < buffers.size(); i++) {
+        dropped += buffers[i]->dropped;
+    }
+    return dropped;
+}
+
+void record(const char* name, int arg, Clock::time_point start) {
+    Event event;
+    event.end = Clock::now();
+    event.name = name;
+    event.arg = arg;
+    event.start = start;
+    ThreadBuffer* buffer = getThreadBuffer();
+    if (buffer->events.size() < MAX_THREAD_EVENTS) {
+        buffer->events.push_back(event);
+    } else {
+        buffer->dropped++;
+    }
+}
+
+// microseconds since start()
+static double toMicroseconds(Clock::time_point time) {
+    std::chrono::duration<double, std::micro> offset = time - trace_start;
+    return offset.count();
+}
+
+void write(std::ostream& out) {
+    checkStopped();
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    char line[256];
+    for (int i = 0; i < buffers.size(); i++) {
+        const ThreadBuffer& buffer = *buffers[i];
+        snprintf(
+            line,
+            sizeof(line),
+            "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+            "\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+            first ? "" : ",",
+            buffer.tid,
+            buffer.tid
+        );
+        out << line;
+        first = false;
+        for (int e = 0; e < buffer.events.size(); e++) {
+            const Event& event = buffer.events[e];
+            double start = toMicroseconds(event.start);
+            double duration = toMicroseconds(event.end) - start;
+            snprintf(
+                line,
+                sizeof(line),
+                ",\n{\"name\":\"%s\",\"cat\":\"bacteria\",\"ph\":\"X\","
+                "\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d",
+                event.name,
+                start,
+                duration,
+                buffer.tid
+            );
+            out << line;
+            if (event.arg != -1) {
+                out << ",\"args\":{\"n\":" << event.arg << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+}
+
+}
@@ -0,0 +1,93 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef TRACE_HPP_
+#define TRACE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+
+/** Timeline of phases of the engine in Chrome trace event format
+(open the file in about:tracing or ui.perfetto.dev).
+
+Phases are marked by TRACE_SCOPE(name, arg). While tracing is not
+started a scope costs one relaxed load of a flag. Every thread
+records its events to its own buffer.
+*/
+namespace Trace {
+
+/** Maximum number of events recorded by one thread,
+further events are dropped */
+const int MAX_THREAD_EVENTS = 1024 * 1024;
+
+extern std::atomic<bool> active;
+
+inline bool isActive() {
+    return active.load(std::memory_order_relaxed);
+}
+
+/** Clear recorded events and start recording.
+Must not be called while traced code is running. */
+void start();
+
+/** Stop recording */
+void stop();
+
+/* Buffers of threads are read without synchronization with
+recording threads, so the following functions throw Exception
+if tracing is active; they must be called after stop(), when
+traced code is not running. */
+
+/** Return the number of recorded events */
+long long getEventsNumber();
+
+/** Return the number of events dropped because of MAX_THREAD_EVENTS */
+long long getDroppedEvents();
+
+/** Write recorded events as Chrome trace JSON */
+void write(std::ostream& out);
+
+typedef std::chrono::steady_clock Clock;
+
+/** Record the event (called by Scope) */
+void record(const char* name, int arg, Clock::time_point start);
+
+/** Records the event lasting from construction to destruction */
+class Scope {
+public:
+    /** Constructor
+    \param name Name of the phase (static string)
+    \param arg Number shown in arguments of the event (if not -1)
+    */
+    Scope(const char* name, int arg = -1)
+        : name_(NULL) {
+        if (isActive()) {
+            name_ = name;
+            arg_ = arg;
+            start_ = Clock::now();
+        }
+    }
+
+    ~Scope() {
+        if (name_ != NULL) {
+            record(name_, arg_, start_);
+        }
+    }
+
+private:
+    const char* name_;
+    int arg_;
+    Clock::time_point start_;
+};
+
+}
+
+#define TRACE_SCOPE(name, arg) Trace::Scope trace_scope_(name, arg)
+
+#endif
@@ -0,0 +1,17 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef HASH_HPP_
+#define HASH_HPP_
+
+#include <string>
+#include <stdint.h>
+
+/** 64-bit FNV-1a hash of bytes (not cryptographic) */
+uint64_t hashBytes(const std::string& data);
+
+#endif
@@ -7,10 +7,60 @@
 
 #include "random.hpp"
 
-// FIXME
-// This solution is non-working. We must use /dev/urandom
-// or boost.random for good random function.
+static uint32_t rotl(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+// splitmix64 is used to expand the seed into the state
+// of the generator (recommended by xoshiro authors).
+static uint64_t splitmix64(uint64_t& x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    uint64_t z = x;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+Random::Random(uint32_t seed) {
+    this->seed(seed);
+}
+
+void Random::seed(uint32_t seed) {
+    uint64_t x = seed;
+    uint64_t a = splitmix64(x);
+    uint64_t b = splitmix64(x);
+    state_[0] = static_cast<uint32_t>(a);
+    state_[1] = static_cast<uint32_t>(a >> 32);
+    state_[2] = static_cast<uint32_t>(b);
+    state_[3] = static_cast<uint32_t>(b >> 32);
+}
+
+unsigned int Random::next(unsigned int end) {
+    // multiply-shift maps [0, 2^32) to [0, end) without division
+    uint64_t product = static_cast<uint64_t>(nextRaw()) * end;
+    return static_cast<unsigned int>(product >> 32);
+}
+
+void Random::getState(uint32_t* state) const {
+    for (int i = 0; i < STATE_SIZE; i++) {
+        state[i] = state_[i];
+    }
+}
+
+void Random::setState(const uint32_t* state) {
+    for (int i = 0; i < STATE_SIZE; i++) {
+        state_[i] = state[i];
+    }
+}
 
-unsigned int random(unsigned int end) {
-    return rand() / (RAND_MAX / end + 1);
+uint32_t Random::nextRaw() {
+    uint32_t result = rotl(state_[1] * 5, 7) * 9;
+    uint32_t t = state_[1] << 9;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = rotl(state_[3], 11);
+    return result;
 }
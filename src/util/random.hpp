@@ -8,11 +8,40 @@
 #ifndef RANDOM_HPP_
 #define RANDOM_HPP_
 
-#include <cstdlib>
+#include <stdint.h>
 
-/** Return random number from interval [0, end).
-\param end End of interval (not included)
+/** Pseudo-random number generator (xoshiro128**).
+
+Each Model owns its own generator, so games are reproducible
+for the given seed and independent games never share state.
 */
-unsigned int random(unsigned int end);
+class Random {
+public:
+    /** Constructor
+    \param seed Initial seed
+    */
+    Random(uint32_t seed = 0);
+
+    /** Restart the sequence from the given seed */
+    void seed(uint32_t seed);
+
+    /** Return random number from interval [0, end).
+    \param end End of interval (not included)
+    */
+    unsigned int next(unsigned int end);
+
+    static const int STATE_SIZE = 4;
+
+    /** Copy internal state (STATE_SIZE words) to state */
+    void getState(uint32_t* state) const;
+
+    /** Continue the sequence from the state saved by getState() */
+    void setState(const uint32_t* state);
+
+private:
+    uint32_t state_[STATE_SIZE];
+
+    uint32_t nextRaw();
+};
 
 #endif
@@ -0,0 +1,24 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#ifndef TEST_GAMES_HPP_
+#define TEST_GAMES_HPP_
+
+#include "CoreGlobals.hpp"
+#include "Game.hpp"
+
+// Games shared by tests (defined in test/game.cpp)
+
+/** Two scripts with repeated commands, which keep state
+in changers between moves */
+Strings makeRepeatScripts();
+
+/** Parameters of games of makeRepeatScripts():
+board 15 x height, 5 bacteria per team, seed 9 */
+Implementation::GameParams makeRepeatParams(int height = 15);
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "AllocationCounter.hpp"
+#include "Game.hpp"
+
+using namespace Implementation;
+
+// bacteria fill the board and then only feed the neighbours
+// (jumps, turns and enemy searches are executed too)
+static const char* const scripts[] = {
+    "eat 12\nje 3\nleft\nclon\n",
+    "eat 12\nclon\nright\njg 1000 0\n",
+};
+
+// bacteria strike each other, killed bacteria are replaced
+// by clones (births and deaths balance)
+static const char* const churn_scripts[] = {
+    "eat 12\nclon\nstr 2\nright\n",
+    "eat 12\nclon\nstr 2\nleft\n",
+};
+
+static int getChanges(ModelPtr model) {
+    int changes = 0;
+    for (int team = 0; team < model->getTeamsNumber(); team++) {
+        const Abstract::TeamStats& stats = model->getTeamStats(team);
+        changes += stats.clones + stats.deaths;
+    }
+    return changes;
+}
+
+// allocations of moves 300-400, changes are births and deaths
+static long long steadyAllocations(
+    const char* const* game_scripts,
+    bool trusted,
+    int& changes
+) {
+    Game game(
+        Strings(game_scripts, game_scripts + 2),
+        GameParams(8, 8, 5, 1, trusted)
+    );
+    game.run(300);
+    BOOST_REQUIRE(!game.isOver());
+    changes = -getChanges(game.getModel());
+    AllocationCounter counter;
+    game.run(100);
+    long long allocations = counter.getAllocations();
+    BOOST_REQUIRE(game.getMoveNumber() == 400);
+    changes += getChanges(game.getModel());
+    return allocations;
+}
+
+BOOST_AUTO_TEST_CASE (full_board_allocations_test) {
+    for (int trusted = 0; trusted < 2; trusted++) {
+        int changes;
+        BOOST_REQUIRE(steadyAllocations(scripts, trusted, changes) == 0);
+        // numbers of bacteria do not change any more
+        BOOST_REQUIRE(changes == 0);
+    }
+    // the counter counts allocations
+    AllocationCounter counter;
+    Ints ints(10);
+    BOOST_REQUIRE(counter.getAllocations() == 1);
+    BOOST_REQUIRE(counter.getBytes() == 10 * sizeof(int));
+}
+
+BOOST_AUTO_TEST_CASE (churn_allocations_test) {
+    // freed slots of killed bacteria are reused by clones
+    for (int trusted = 0; trusted < 2; trusted++) {
+        int changes;
+        BOOST_REQUIRE(steadyAllocations(churn_scripts, trusted, changes) == 0);
+        BOOST_REQUIRE(changes > 50);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (memory_report_test) {
+    Game game(Strings(scripts, scripts + 2), GameParams(8, 8, 5));
+    MemoryReport report = game.getMemoryReport();
+    BOOST_REQUIRE(report.board >= 8 * 8 * sizeof(int));
+    BOOST_REQUIRE(report.bacteria > 0);
+    BOOST_REQUIRE(report.changers >= 2 * 5 * 3 * sizeof(int));
+    BOOST_REQUIRE(report.program >= 8 * sizeof(PackedInstruction));
+    BOOST_REQUIRE(report.bacteria_number == 10);
+    BOOST_REQUIRE(report.getTotal() == report.board + report.bacteria +
+                  report.changers + report.program);
+    BOOST_REQUIRE(report.getBytesPerBacterium() ==
+                  double(report.bacteria + report.changers) / 10);
+}
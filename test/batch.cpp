@@ -0,0 +1,123 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <stdexcept>
+
+#include <boost/test/unit_test.hpp>
+
+#include "BatchRunner.hpp"
+
+using namespace Implementation;
+
+static BatchJobs makeJobs() {
+    const char* scripts[] = {
+        "go\nje 3\nright 2\nstr\nclon\nj 0\n",
+        "back\ngo r\nje 0\nstr\neat r\nclon\nturn r\n",
+        "eat 3\nclon\ngo\nleft\n",
+    };
+    BatchJobs jobs;
+    for (int i = 0; i < 24; i++) {
+        Strings job_scripts;
+        job_scripts.push_back(scripts[i % 3]);
+        job_scripts.push_back(scripts[(i + 1) % 3]);
+        GameParams params(5 + i % 4, 6, 1 + i % 3, i, i % 2);
+        jobs.push_back(BatchJob(job_scripts, params, 30 + i));
+    }
+    return jobs;
+}
+
+static void checkSameResults(
+    const BatchResults& r1,
+    const BatchResults& r2
+) {
+    BOOST_REQUIRE(r1.size() == r2.size());
+    for (int i = 0; i < r1.size(); i++) {
+        BOOST_REQUIRE(r1[i].moves == r2[i].moves);
+        BOOST_REQUIRE(r1[i].winner == r2[i].winner);
+        BOOST_REQUIRE(r1[i].bacteria == r2[i].bacteria);
+        BOOST_REQUIRE(r1[i].masses == r2[i].masses);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (batch_threads_test) {
+    BatchJobs jobs = makeJobs();
+    BatchRunner r1(1);
+    BatchRunner r4(4);
+    BatchResults results = r1.run(jobs);
+    checkSameResults(results, r4.run(jobs));
+    // second run reuses models of workers
+    checkSameResults(results, r4.run(jobs));
+    // results are equal to results of separate games
+    for (int i = 0; i < jobs.size(); i++) {
+        Game game(jobs[i].scripts, jobs[i].params);
+        BOOST_REQUIRE(game.run(jobs[i].moves) == results[i].moves);
+        BOOST_REQUIRE(game.getWinner() == results[i].winner);
+        BOOST_REQUIRE(game.getTotalMass(0) == results[i].masses[0]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (batch_callback_test) {
+    BatchJobs jobs = makeJobs();
+    BatchRunner runner(3);
+    Ints finished(jobs.size(), 0);
+    // Boost.Test is not thread-safe, check after run()
+    BatchResults results = runner.run(
+        jobs,
+        [&](int job, const BatchResult& result) {
+            finished[job] += result.bacteria.size();
+        }
+    );
+    BOOST_REQUIRE(finished == Ints(jobs.size(), 2));
+    // 3 different scripts
+    BOOST_REQUIRE(runner.getCache().getMisses() == 3);
+    BOOST_REQUIRE(runner.getCache().getHits() == 2 * jobs.size() - 3);
+}
+
+BOOST_AUTO_TEST_CASE (game_reset_test) {
+    BatchJobs jobs = makeJobs();
+    BytecodeCache cache;
+    Game game(cache.get(jobs[0].scripts), jobs[0].params);
+    game.run(jobs[0].moves);
+    for (int i = 1; i < jobs.size(); i++) {
+        game.reset(cache.get(jobs[i].scripts), jobs[i].params);
+        Game fresh(jobs[i].scripts, jobs[i].params);
+        BOOST_REQUIRE(game.getTotalMass(1) == fresh.getTotalMass(1));
+        int played = game.run(jobs[i].moves);
+        BOOST_REQUIRE(played == fresh.run(jobs[i].moves));
+        BOOST_REQUIRE(game.getWinner() == fresh.getWinner());
+        BOOST_REQUIRE(game.getTotalMass(0) == fresh.getTotalMass(0));
+        BOOST_REQUIRE(game.getTotalMass(1) == fresh.getTotalMass(1));
+    }
+}
+
+BOOST_AUTO_TEST_CASE (bytecode_cache_limit_test) {
+    BytecodeCache cache(2);
+    BytecodePtr used = cache.get("eat\n");
+    cache.get("go\n");
+    // the full cache drops scripts which are not used
+    cache.get("clon\n");
+    BOOST_REQUIRE(cache.size() == 2);
+    BOOST_REQUIRE(cache.get("eat\n") == used);
+    BOOST_REQUIRE(cache.getMisses() == 3);
+    cache.get("go\n");
+    BOOST_REQUIRE(cache.getMisses() == 4);
+}
+
+BOOST_AUTO_TEST_CASE (thread_pool_exception_test) {
+    ThreadPool pool(2);
+    BOOST_REQUIRE_THROW(pool.run(10, [](int worker, int task) {
+        if (task == 5) {
+            throw std::runtime_error("task failed");
+        }
+    }), std::runtime_error);
+    // pool is usable after an exception
+    Ints done(10, 0);
+    pool.run(10, [&](int worker, int task) {
+        done[task] = 1;
+    });
+    BOOST_REQUIRE(done == Ints(10, 1));
+}
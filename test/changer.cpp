@@ -0,0 +1,109 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "Model.hpp"
+#include "Changer.hpp"
+#include "Interpreter.hpp"
+
+// pairs of Model and Changer with the same validation policy
+template<typename TModel, typename TChanger>
+struct Engine {
+    typedef TModel Model;
+    typedef TChanger Changer;
+};
+
+typedef boost::mpl::list <
+    Engine<Implementation::Model, Implementation::Changer>,
+    Engine<Implementation::TrustedModel, Implementation::TrustedChanger>
+> Engines;
+
+// state of the bacterium after each move: mass, direction, instruction
+template<typename TEngine>
+static Ints playMoves(const std::string& script, int moves) {
+    typedef typename TEngine::Model TModel;
+    typedef typename TEngine::Changer TChanger;
+    ModelPtr model(Abstract::makeModel<TModel>(
+        MIN_WIDTH,
+        MIN_HEIGHT,
+        0,
+        1
+    ));
+    model->createNewByCoordinates(
+        Abstract::Point(2, 2),
+        100,
+        Abstract::LEFT,
+        0,
+        0
+    );
+    Implementation::Interpreter interpreter;
+    interpreter.makeBytecode(Strings(1, script));
+    int instructions = std::count(script.begin(), script.end(), '\n');
+    TChanger changer(model, 0, 0, instructions);
+    Ints result;
+    for (int move = 0; move < moves; move++) {
+        interpreter.makeMove(changer, NULL);
+        result.push_back(model->getMass(0, 0));
+        result.push_back(model->getDirection(0, 0));
+        result.push_back(model->getInstruction(0, 0));
+    }
+    return result;
+}
+
+template<typename TEngine>
+static void checkMoves(
+    const std::string& script,
+    const int* expected,
+    int moves
+) {
+    Ints result = playMoves<TEngine>(script, moves);
+    for (int i = 0; i < moves * 3; i++) {
+        BOOST_REQUIRE(result[i] == expected[i]);
+    }
+}
+
+// Expected values were recorded with step-by-step execution
+// of repeated commands (before closed forms were introduced).
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (repeated_pseudo_actions_test, E, Engines) {
+    const int left20[] = {
+        95, 2, 0, 90, 0, 0, 85, 2, 0, 80, 0, 0
+    };
+    checkMoves<E>("left 20\n", left20, 4);
+    const int back_right_left[] = {
+        95, 3, 2, 90, 2, 1, 85, 1, 1, 80, 0, 1, 75, 3, 1
+    };
+    checkMoves<E>("back\nright 29\nleft 2\n", back_right_left, 5);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (repeated_actions_test, E, Engines) {
+    const int eat50[] = {
+        101, 0, 0, 102, 0, 0, 103, 0, 0, 104, 0, 0
+    };
+    checkMoves<E>("eat 50\nleft 3\n", eat50, 4);
+    const int mixed[] = {
+        101, 3, 1, 102, 3, 1, 103, 3, 2,
+        104, 0, 1, 105, 0, 1, 106, 0, 2
+    };
+    checkMoves<E>("right 7\neat 3\nback\n", mixed, 6);
+}
+
+// scripts which would fail in Changer are rejected by the compiler
+BOOST_AUTO_TEST_CASE (bytecode_ranges_test) {
+    using Implementation::Bytecode;
+    const char* const invalid[] = {
+        "eat 0\n", "eat 1\n", "left 100\n", "go 1000\n",
+        "j 1\n", "eat\nje 2\n", "eat\njg 5 2\n", "jl 0 7\n",
+    };
+    for (int i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        BOOST_REQUIRE_THROW(Bytecode::make(invalid[i]), Exception);
+    }
+    BytecodePtr bytecode = Bytecode::make("eat 2\nright 99\njg 500 0\nj 2\n");
+    BOOST_REQUIRE(bytecode->getInstructionsNumber() == 4);
+}
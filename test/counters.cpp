@@ -0,0 +1,60 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "Counters.hpp"
+#include "BatchRunner.hpp"
+
+using namespace Implementation;
+
+// every bacterium makes MAX_PSEUDO_ACTIONS jumps and dies of penalty
+static const char* const JUMPER = "j 0\n";
+
+static void checkJumpers(const Counters::Values& counters, int games) {
+    // 2 teams of 3 bacteria
+    int bacteria = games * 2 * 3;
+    BOOST_REQUIRE(counters[Counters::COMMAND_J] ==
+                  bacteria * MAX_PSEUDO_ACTIONS);
+    BOOST_REQUIRE(counters[Counters::COMMAND_EAT] == 0);
+    BOOST_REQUIRE(counters[Counters::PSEUDO_ACTION_PENALTIES] == bacteria);
+    BOOST_REQUIRE(counters[Counters::DEATHS_PENALTY] == bacteria);
+    BOOST_REQUIRE(counters[Counters::DEATHS_GO] == 0);
+    BOOST_REQUIRE(counters[Counters::TEAM_MOVES] == games * 2);
+}
+
+BOOST_AUTO_TEST_CASE (counters_test) {
+    BOOST_REQUIRE(Counters::isEnabled());
+    Counters::Values before = Counters::getCounters();
+    Game game(Strings(2, JUMPER), GameParams(10, 10, 3));
+    BOOST_REQUIRE(game.run(10) == 1);
+    checkJumpers(Counters::getCounters() - before, 1);
+    // je searches an enemy every time
+    before = Counters::getCounters();
+    Game searcher(Strings(2, "je 0\n"), GameParams(10, 10, 3));
+    searcher.run(1);
+    Counters::Values searches = Counters::getCounters() - before;
+    BOOST_REQUIRE(searches[Counters::ROUND_ENEMY_SEARCHES] ==
+                  searches[Counters::COMMAND_JE]);
+    BOOST_REQUIRE(searches[Counters::COMMAND_JE] > 0);
+}
+
+BOOST_AUTO_TEST_CASE (counters_threads_test) {
+    Counters::Values before = Counters::getCounters();
+    BatchJobs jobs;
+    for (int i = 0; i < 8; i++) {
+        jobs.push_back(BatchJob(
+            Strings(2, JUMPER),
+            GameParams(10, 10, 3, i),
+            10
+        ));
+    }
+    BatchRunner runner(3);
+    runner.run(jobs);
+    // counters of all threads are summed
+    checkJumpers(Counters::getCounters() - before, 8);
+}
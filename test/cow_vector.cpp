@@ -0,0 +1,43 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "CowVector.hpp"
+
+BOOST_AUTO_TEST_CASE (cow_vector_test) {
+    const int size = CowVector<int>::CHUNK_SIZE * 3 + 5;
+    CowVector<int> original;
+    for (int i = 0; i < size; i++) {
+        original.push_back(i);
+    }
+    BOOST_REQUIRE(original.size() == size);
+    BOOST_REQUIRE(original.sharedChunks() == 0);
+    CowVector<int> copy = original;
+    BOOST_REQUIRE(original.sharedChunks() == 4);
+    // only the changed chunk is copied
+    copy.edit(CowVector<int>::CHUNK_SIZE + 1) = -1;
+    BOOST_REQUIRE(copy.sharedChunks() == 3);
+    BOOST_REQUIRE(original[CowVector<int>::CHUNK_SIZE + 1] ==
+                  CowVector<int>::CHUNK_SIZE + 1);
+    BOOST_REQUIRE(copy[CowVector<int>::CHUNK_SIZE + 1] == -1);
+    original.edit(0) = -2;
+    BOOST_REQUIRE(copy[0] == 0);
+    BOOST_REQUIRE(original.sharedChunks() == 2);
+    copy.pop_back();
+    copy.push_back(7);
+    BOOST_REQUIRE(original.back() == size - 1);
+    BOOST_REQUIRE(copy.back() == 7);
+    copy.resize(2);
+    copy.resize(4, 9);
+    BOOST_REQUIRE(copy[1] == 1);
+    BOOST_REQUIRE(copy[3] == 9);
+    BOOST_REQUIRE(original[3] == 3);
+    copy.clear();
+    BOOST_REQUIRE(copy.empty());
+    BOOST_REQUIRE(original.sharedChunks() == 0);
+}
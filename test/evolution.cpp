@@ -0,0 +1,122 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "Evolution.hpp"
+#include "ScriptGenerator.hpp"
+
+using namespace Implementation;
+
+static void checkScript(const PackedInstructions& script, int seed) {
+    BOOST_REQUIRE(!script.empty());
+    std::string source = ScriptGenerator::toSource(script);
+    BytecodePtr bytecode = Bytecode::make(source);
+    BOOST_REQUIRE(ScriptGenerator::toSource(
+        ScriptGenerator::fromBytecode(*bytecode)
+    ) == source);
+    // checked game throws if the script is invalid
+    Strings scripts(2, source);
+    Game game(scripts, GameParams(10, 10, 3, seed));
+    game.run(20);
+}
+
+BOOST_AUTO_TEST_CASE (script_generator_test) {
+    ScriptGenerator generator(5, 12);
+    for (int i = 0; i < 100; i++) {
+        PackedInstructions first = generator.makeScript(1 + i % 12);
+        checkScript(first, i);
+        PackedInstructions second = generator.makeScript(3);
+        for (int m = 0; m < 10; m++) {
+            generator.mutate(second);
+        }
+        BOOST_REQUIRE(second.size() <= 12);
+        checkScript(second, i);
+        PackedInstructions child = generator.crossover(first, second);
+        BOOST_REQUIRE(child.size() <= 12);
+        checkScript(child, i);
+    }
+    PackedInstructions empty;
+    BOOST_REQUIRE_THROW(generator.mutate(empty), Exception);
+}
+
+static void countKinds(
+    const PackedInstructions& script,
+    int& actions,
+    int& jumps
+) {
+    actions = 0;
+    jumps = 0;
+    for (int i = 0; i < script.size(); i++) {
+        actions += ScriptGenerator::isAction(script[i].function_id);
+        jumps += ScriptGenerator::isJump(script[i].function_id);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (script_mix_test) {
+    int actions, jumps;
+    ScriptGenerator only_actions(1, 100, ScriptMix(1, 0, 0));
+    PackedInstructions script = only_actions.makeScript(100);
+    checkScript(script, 1);
+    countKinds(script, actions, jumps);
+    BOOST_REQUIRE(actions == 100);
+    ScriptGenerator only_jumps(2, 100, ScriptMix(0, 0, 1));
+    script = only_jumps.makeScript(100);
+    checkScript(script, 2);
+    countKinds(script, actions, jumps);
+    BOOST_REQUIRE(jumps == 100);
+    // 3 actions per pseudo action
+    ScriptGenerator mixed(3, 1000, ScriptMix(3, 1, 0));
+    script = mixed.makeScript(1000);
+    checkScript(script, 3);
+    countKinds(script, actions, jumps);
+    BOOST_REQUIRE(jumps == 0);
+    BOOST_REQUIRE(actions > 700 && actions < 800);
+    // default mix does not change generated scripts
+    ScriptGenerator first(4), second(4, DEFAULT_MAX_SCRIPT_LENGTH,
+                                     ScriptMix(2, 2, 2));
+    BOOST_REQUIRE(ScriptGenerator::toSource(first.makeScript(30)) ==
+                  ScriptGenerator::toSource(second.makeScript(30)));
+    BOOST_REQUIRE_THROW(ScriptGenerator(1, 10, ScriptMix(0, 0, 0)),
+                        Exception);
+    BOOST_REQUIRE_THROW(ScriptGenerator(1, 10, ScriptMix(1, -1, 1)),
+                        Exception);
+}
+
+BOOST_AUTO_TEST_CASE (evolution_test) {
+    Strings initial;
+    initial.push_back("eat 20\ngo r\nturn r\nclon\n");
+    Strings opponents;
+    opponents.push_back("eat 20\ngo r\nturn r\nclon\nleft 3\n");
+    opponents.push_back("eat\nclon\nright 2\n");
+    EvolutionParams params(GameParams(12, 12, 3), 2, 60, 8);
+    params.seed = 3;
+    Evolution single(initial, opponents, params);
+    Evolution parallel(initial, opponents, params);
+    BatchRunner runner1(1);
+    BatchRunner runner3(3);
+    double best_fitness = -1;
+    for (int generation = 1; generation <= 4; generation++) {
+        single.step(runner1);
+        parallel.step(runner3);
+        BOOST_REQUIRE(single.getGeneration() == generation);
+        BOOST_REQUIRE(single.getRanking().size() == 8);
+        const Individual& best = single.getBest();
+        BOOST_REQUIRE(best.script == parallel.getBest().script);
+        BOOST_REQUIRE(best.fitness == parallel.getBest().fitness);
+        // the elite survives, so the best fitness does not decrease
+        BOOST_REQUIRE(best.fitness >= best_fitness);
+        best_fitness = best.fitness;
+    }
+    // fitness of surviving scripts is not evaluated again
+    BOOST_REQUIRE(single.getPlayedGames() > 0);
+    BOOST_REQUIRE(single.getPlayedGames() < 4 * 8 * 4);
+    BOOST_REQUIRE_THROW(
+        Evolution(initial, Strings(), params),
+        Exception
+    );
+}
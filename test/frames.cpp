@@ -0,0 +1,50 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <sstream>
+
+#include <boost/test/unit_test.hpp>
+
+#include "FrameStream.hpp"
+#include "Game.hpp"
+#include "TestGames.hpp"
+
+using namespace Implementation;
+
+BOOST_AUTO_TEST_CASE (frame_stream_test) {
+    Game game(makeRepeatScripts(), makeRepeatParams(12));
+    std::stringstream stream;
+    FrameWriter writer(stream, 15, 12, 10);
+    std::vector<Frame> frames;
+    for (int move = 0; move <= 45; move++) {
+        if (move > 0) {
+            game.step();
+        }
+        writer.write(*game.getModel(), game.getMoveNumber());
+        frames.push_back(Frame(15, 12));
+        frames.back().load(*game.getModel(), game.getMoveNumber());
+    }
+    BOOST_REQUIRE(writer.getFramesNumber() == 46);
+    FrameReader reader(stream);
+    BOOST_REQUIRE(reader.getFramesNumber() == 46);
+    BOOST_REQUIRE(reader.getWidth() == 15);
+    BOOST_REQUIRE(reader.getMove(45) == 45);
+    // scrubbing in any order
+    int order[] = {0, 1, 2, 33, 17, 45, 44, 9, 10, 11, 31, 45, 3};
+    for (int i = 0; i < sizeof(order) / sizeof(int); i++) {
+        const Frame& frame = reader.read(order[i]);
+        BOOST_REQUIRE(frame.move == order[i]);
+        BOOST_REQUIRE(frame.cells == frames[order[i]].cells);
+    }
+    BOOST_REQUIRE_THROW(reader.read(46), Exception);
+    // corrupted stream
+    std::stringstream truncated(stream.str().substr(0, 30));
+    BOOST_REQUIRE_THROW(FrameReader bad(truncated), Exception);
+    std::string data = stream.str();
+    std::stringstream short_payload(data.substr(0, data.size() - 3));
+    BOOST_REQUIRE_THROW(FrameReader bad(short_payload), Exception);
+}
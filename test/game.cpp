@@ -0,0 +1,209 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "BinaryStream.hpp"
+#include "Exception.hpp"
+#include "Game.hpp"
+#include "TestGames.hpp"
+
+static Strings makeScripts(const char* script1, const char* script2) {
+    Strings scripts;
+    scripts.push_back(script1);
+    scripts.push_back(script2);
+    return scripts;
+}
+
+Strings makeRepeatScripts() {
+    return makeScripts(
+        "eat 20\ngo r\nturn r\nclon\nleft 3\n",
+        "eat 20\ngo r\nturn r\nclon\nright 2\n"
+    );
+}
+
+Implementation::GameParams makeRepeatParams(int height) {
+    return Implementation::GameParams(15, height, 5, 9);
+}
+
+BOOST_AUTO_TEST_CASE (game_early_exit_test) {
+    // clon kills bacteria of team 1 (mass is too small)
+    Strings scripts = makeScripts("eat\n", "clon\n");
+    Implementation::Game game(
+        scripts,
+        Implementation::GameParams(10, 10, 3, 1)
+    );
+    BOOST_REQUIRE(!game.isOver());
+    BOOST_REQUIRE(game.getBacteriaNumber(0) == 3);
+    BOOST_REQUIRE(game.getTotalMass(1) == 3 * DEFAULT_MASS);
+    int played = game.run(100);
+    BOOST_REQUIRE(played == 1);
+    BOOST_REQUIRE(game.getMoveNumber() == 1);
+    BOOST_REQUIRE(game.isOver());
+    BOOST_REQUIRE(game.getWinner() == 0);
+    BOOST_REQUIRE(game.getAliveTeams() == 1);
+    BOOST_REQUIRE(game.getBacteriaNumber(1) == 0);
+    BOOST_REQUIRE(game.getTotalMass(0) == 3 * (DEFAULT_MASS + EAT_MASS));
+    BOOST_REQUIRE(!game.step());
+    BOOST_REQUIRE(game.run(10) == 0);
+    // dead bacteria are still in the model between moves (see getModel)
+    ModelPtr model = game.getModel();
+    BOOST_REQUIRE(model->getTeamStats(1).alive == 0);
+    BOOST_REQUIRE_THROW(model->getBacteriaNumber(1), Exception);
+}
+
+BOOST_AUTO_TEST_CASE (game_run_test) {
+    Strings scripts = makeScripts("eat\n", "eat 2\nleft\n");
+    Implementation::Game game(
+        scripts,
+        Implementation::GameParams(10, 10, 2, 1)
+    );
+    BOOST_REQUIRE(game.run(7) == 7);
+    BOOST_REQUIRE(game.step());
+    BOOST_REQUIRE(game.getMoveNumber() == 8);
+    BOOST_REQUIRE(game.getWinner() == -1);
+    BOOST_REQUIRE(game.getTotalMass(0) == 2 * (DEFAULT_MASS + 8));
+}
+
+BOOST_AUTO_TEST_CASE (game_seed_test) {
+    Strings scripts = makeScripts(
+        "go\nje 3\nright 2\nstr\nclon\nj 0\n",
+        "back\ngo r\nje 0\nstr\neat r\nclon\nturn r\n"
+    );
+    for (int trusted = 0; trusted < 2; trusted++) {
+        Implementation::GameParams params(8, 8, 4, 42, trusted);
+        Implementation::Game game1(scripts, params);
+        Implementation::Game game2(scripts, params);
+        int played1 = game1.run(50);
+        int played2 = game2.run(50);
+        BOOST_REQUIRE(played1 == played2);
+        for (int team = 0; team < 2; team++) {
+            int mass1 = game1.getTotalMass(team);
+            BOOST_REQUIRE(mass1 == game2.getTotalMass(team));
+            int bacteria1 = game1.getBacteriaNumber(team);
+            BOOST_REQUIRE(bacteria1 == game2.getBacteriaNumber(team));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE (game_snapshot_test) {
+    // snapshot is made in the middle of repeated commands
+    Strings scripts = makeRepeatScripts();
+    Implementation::GameParams params = makeRepeatParams();
+    Implementation::Game game(scripts, params);
+    game.run(13);
+    std::string image = game.snapshot();
+    uint64_t hash = game.getStateHash();
+    game.run(20);
+    Implementation::Game copy(scripts, params);
+    copy.restore(image);
+    BOOST_REQUIRE(copy.getMoveNumber() == 13);
+    BOOST_REQUIRE(copy.getStateHash() == hash);
+    copy.run(20);
+    BOOST_REQUIRE(copy.getMoveNumber() == game.getMoveNumber());
+    BOOST_REQUIRE(copy.getStateHash() == game.getStateHash());
+    BOOST_REQUIRE_THROW(copy.restore(image.substr(1)), Exception);
+}
+
+// image of the game with the image of the changer of team 1
+// replaced by a changer image with too many bacteria
+static std::string makeLongChangerImage(const std::string& image) {
+    BinaryReader reader(image);
+    std::string result;
+    BinaryWriter writer(result);
+    BOOST_REQUIRE(reader.readBytes("BCTG", 4));
+    writer.writeBytes("BCTG", 4);
+    writer.writeUint(reader.readUint());
+    writer.writeInt(reader.readInt());
+    int teams = reader.readInt();
+    writer.writeInt(teams);
+    writer.writeString(reader.readString());
+    writer.writeString(reader.readString());
+    reader.readString();
+    std::string changer;
+    BinaryWriter changer_writer(changer);
+    changer_writer.writeInt(1);
+    int size = 1000;
+    for (int vector = 0; vector < 3; vector++) {
+        changer_writer.writeInt(size);
+        for (int i = 0; i < size; i++) {
+            changer_writer.writeInt(0);
+        }
+    }
+    writer.writeString(changer);
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE (game_restore_checks_test) {
+    Strings scripts = makeRepeatScripts();
+    Implementation::GameParams params = makeRepeatParams();
+    Implementation::Game game(scripts, params);
+    // bacteria are in the middle of their scripts after "eat 20"
+    game.run(22);
+    std::string image = game.snapshot();
+    Implementation::Game copy(scripts, params);
+    copy.run(2);
+    uint64_t hash = copy.getStateHash();
+    ModelPtr model = copy.getModel();
+    // changer has more bacteria than the model
+    BOOST_REQUIRE_THROW(
+        copy.restore(makeLongChangerImage(image)),
+        Exception
+    );
+    // failed restore does not change the game
+    BOOST_REQUIRE(copy.getModel() == model);
+    BOOST_REQUIRE(copy.getMoveNumber() == 2);
+    BOOST_REQUIRE(copy.getStateHash() == hash);
+    // bacteria refer to instructions out of shorter scripts
+    Implementation::Game short_game(makeScripts("eat\n", "eat\n"), params);
+    BOOST_REQUIRE_THROW(short_game.restore(image), Exception);
+    BOOST_REQUIRE(short_game.getMoveNumber() == 0);
+    copy.restore(image);
+    BOOST_REQUIRE(copy.getStateHash() == game.getStateHash());
+}
+
+BOOST_AUTO_TEST_CASE (game_fork_test) {
+    // forks are made in the middle of repeated commands
+    Strings scripts = makeRepeatScripts();
+    Implementation::GameParams params = makeRepeatParams();
+    Implementation::Game game(scripts, params);
+    game.run(13);
+    std::string image = game.snapshot();
+    std::unique_ptr<Implementation::Game> rollout1 = game.fork(1);
+    std::unique_ptr<Implementation::Game> rollout2 = game.fork(2);
+    BOOST_REQUIRE(rollout1->getMoveNumber() == 13);
+    rollout1->run(30);
+    rollout2->run(30);
+    // different seeds give different rollouts
+    BOOST_REQUIRE(rollout1->getStateHash() != rollout2->getStateHash());
+    BOOST_REQUIRE(game.snapshot() == image);
+    // the fork continues the game with states of changers
+    Implementation::Game restored(scripts, params);
+    restored.restore(image);
+    restored.getModel()->reseed(1);
+    restored.run(30);
+    BOOST_REQUIRE(restored.getStateHash() == rollout1->getStateHash());
+}
+
+BOOST_AUTO_TEST_CASE (game_restore_dead_test) {
+    // clon kills bacteria of team 1 (mass is too small), they are
+    // kept in the model until the next move of team 1
+    Strings scripts = makeScripts("eat\n", "clon\n");
+    scripts.push_back("eat\n");
+    Implementation::GameParams params(10, 10, 3, 1);
+    Implementation::Game game(scripts, params);
+    BOOST_REQUIRE(game.step());
+    ModelPtr model = game.getModel();
+    BOOST_REQUIRE(model->getTeamStats(1).alive == 0);
+    BOOST_REQUIRE(model->getListSize(1) == 3);
+    Implementation::Game copy(scripts, params);
+    copy.restore(game.snapshot());
+    BOOST_REQUIRE(copy.getStateHash() == game.getStateHash());
+    game.run(5);
+    copy.run(5);
+    BOOST_REQUIRE(copy.getStateHash() == game.getStateHash());
+}
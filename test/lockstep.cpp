@@ -0,0 +1,196 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+
+#include "Lockstep.hpp"
+
+using namespace Implementation;
+
+static bool compareTeamsDescending(const Unit& first, const Unit& second) {
+    return first.team > second.team;
+}
+
+// turns right instead of left
+class BrokenChanger : public TrustedChanger {
+public:
+    BrokenChanger(
+        ModelPtr model,
+        int team,
+        int move_number,
+        int instructions
+    )
+        : TrustedChanger(model, team, move_number, instructions) {
+    }
+
+protected:
+    void left_impl(
+        const Abstract::Params* params,
+        int bacterium_index
+    ) {
+        right_impl(params, bacterium_index);
+    }
+};
+
+static Engine makeBrokenEngine(
+    const BytecodePtrs& bytecode,
+    const GameMap& map
+) {
+    Engine engine = makeTrustedEngine(bytecode, map);
+    for (int team = 0; team < map.teams; team++) {
+        engine.changers[team] = ChangerPtr(new BrokenChanger(
+            engine.model,
+            team,
+            0,
+            engine.interpreter->getInstructionsNumber(team)
+        ));
+    }
+    return engine;
+}
+
+// bacteria of team 1 skip moves
+class BrokenInterpreter : public Interpreter {
+protected:
+    void makeMove_impl(
+        Abstract::Changer& changer,
+        Abstract::State* st
+    ) const {
+        if (changer.getTeam() == 1) {
+            changer.clearBeforeMove();
+        } else {
+            Interpreter::makeMove_impl(changer, st);
+        }
+    }
+};
+
+static Engine makeBrokenInterpreterEngine(
+    const BytecodePtrs& bytecode,
+    const GameMap& map
+) {
+    Engine engine = makeTrustedEngine(bytecode, map);
+    engine.interpreter = InterpreterPtr(new BrokenInterpreter);
+    engine.interpreter->setBytecode(bytecode);
+    return engine;
+}
+
+// the same bacteria are stored in other places of the model
+static Engine makeReorderedEngine(
+    const BytecodePtrs& bytecode,
+    const GameMap& map
+) {
+    GameMap reordered = map;
+    std::stable_sort(
+        reordered.bacteria.begin(),
+        reordered.bacteria.end(),
+        compareTeamsDescending
+    );
+    return makeTrustedEngine(bytecode, reordered);
+}
+
+static Engine makeReseededEngine(
+    const BytecodePtrs& bytecode,
+    const GameMap& map
+) {
+    Engine engine = makeTrustedEngine(bytecode, map);
+    engine.model->reseed(map.seed + 1);
+    return engine;
+}
+
+BOOST_AUTO_TEST_CASE (lockstep_random_cases_test) {
+    for (int seed = 1; seed <= 10; seed++) {
+        int teams = 2 + seed % 3;
+        LockstepCase lockstep_case = makeLockstepCase(seed, 15, 15, teams, 8);
+        BOOST_REQUIRE(lockstep_case.scripts.size() == teams);
+        BOOST_REQUIRE(lockstep_case.map.bacteria.size() == teams * 8);
+        LockstepChecker checker(
+            lockstep_case.scripts,
+            lockstep_case.map,
+            makeCheckedEngine,
+            makeTrustedEngine
+        );
+        Divergence divergence = checker.run(100);
+        BOOST_REQUIRE(!divergence.found());
+    }
+    // the case depends on the seed only
+    LockstepCase first = makeLockstepCase(5, 10, 10, 2, 3);
+    LockstepCase second = makeLockstepCase(5, 10, 10, 2, 3);
+    BOOST_REQUIRE(first.scripts == second.scripts);
+    BOOST_REQUIRE(first.map.bacteria.size() == 6);
+    for (int i = 0; i < first.map.bacteria.size(); i++) {
+        const Unit& unit = first.map.bacteria[i];
+        BOOST_REQUIRE(unit.coordinates == second.map.bacteria[i].coordinates);
+        BOOST_REQUIRE(unit.mass == second.map.bacteria[i].mass);
+    }
+    BOOST_REQUIRE_THROW(makeLockstepCase(5, 4, 4, 2, 5), Exception);
+}
+
+BOOST_AUTO_TEST_CASE (lockstep_broken_engine_test) {
+    GameMap map;
+    map.width = 10;
+    map.height = 10;
+    map.teams = 2;
+    map.seed = 1;
+    map.bacteria.push_back(Unit(Abstract::Point(1, 1), 5, 0, 0, 0));
+    map.bacteria.push_back(Unit(Abstract::Point(8, 8), 5, 0, 1, 0));
+    map.bacteria.push_back(Unit(Abstract::Point(5, 5), 5, 0, 1, 0));
+    Strings scripts;
+    scripts.push_back("eat\n");
+    scripts.push_back("eat\nleft\n");
+    LockstepChecker checker(
+        scripts,
+        map,
+        makeCheckedEngine,
+        makeBrokenEngine
+    );
+    Divergence divergence = checker.run(10);
+    BOOST_REQUIRE(divergence.found());
+    BOOST_REQUIRE(divergence.move == 1);
+    BOOST_REQUIRE(divergence.team == 1);
+    BOOST_REQUIRE(divergence.bacterium == 0);
+    BOOST_REQUIRE(divergence.command == "left");
+    BOOST_REQUIRE(divergence.description.find("cell (") == 0);
+    // the tested engine plays by its own interpreter
+    LockstepChecker interpreter_checker(
+        scripts,
+        map,
+        makeCheckedEngine,
+        makeBrokenInterpreterEngine
+    );
+    divergence = interpreter_checker.run(10);
+    BOOST_REQUIRE(divergence.found());
+    BOOST_REQUIRE(divergence.move == 0);
+    BOOST_REQUIRE(divergence.team == 1);
+    BOOST_REQUIRE(divergence.bacterium == -1);
+    BOOST_REQUIRE(divergence.command.empty());
+}
+
+BOOST_AUTO_TEST_CASE (lockstep_observable_state_test) {
+    LockstepCase lockstep_case = makeLockstepCase(3, 15, 15, 3, 8);
+    // internal layout of the model is not compared
+    LockstepChecker reordered(
+        lockstep_case.scripts,
+        lockstep_case.map,
+        makeCheckedEngine,
+        makeReorderedEngine
+    );
+    BOOST_REQUIRE(!reordered.run(100).found());
+    BOOST_REQUIRE(reordered.getMoveNumber() > 0);
+    // random generators are compared by their next numbers
+    LockstepChecker reseeded(
+        lockstep_case.scripts,
+        lockstep_case.map,
+        makeCheckedEngine,
+        makeReseededEngine
+    );
+    Divergence divergence = reseeded.run(100);
+    BOOST_REQUIRE(divergence.found());
+    BOOST_REQUIRE(divergence.move == 0);
+    BOOST_REQUIRE(divergence.team == -1);
+    BOOST_REQUIRE(divergence.description == "random generators differ");
+}
@@ -0,0 +1,139 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <sstream>
+
+#include <boost/test/unit_test.hpp>
+
+#include "MapYaml.hpp"
+#include "FrameStream.hpp"
+#include "TestGames.hpp"
+
+using namespace Implementation;
+
+static void readMapText(const char* text, GameMap& map) {
+    std::istringstream input(text);
+    readYamlMap(input, map);
+}
+
+BOOST_AUTO_TEST_CASE (map_read_test) {
+    GameMap map;
+    readMapText(
+        "# test map\n"
+        "---\n"
+        "width: 10\n"
+        "height: 7\n"
+        "comment: other keys are ignored\n"
+        "bacteria:\n"
+        "  - {x: 1, y: 2, team: 0, mass: 8, direction: 3}\n"
+        "  - x: 9\n"
+        "    y: 6  # corner\n"
+        "    team: 2\n"
+        "    instruction: 4\n"
+        "- {team: 1, x: 0, y: 0}\n"
+        "results:\n"
+        "  - {team: 0, bacteria: 1}\n",
+        map
+    );
+    BOOST_REQUIRE(map.width == 10);
+    BOOST_REQUIRE(map.height == 7);
+    BOOST_REQUIRE(map.teams == 3);
+    BOOST_REQUIRE(map.seed == DEFAULT_SEED);
+    BOOST_REQUIRE(map.bacteria.size() == 3);
+    BOOST_REQUIRE(map.bacteria[0].mass == 8);
+    BOOST_REQUIRE(map.bacteria[0].direction == 3);
+    BOOST_REQUIRE(map.bacteria[1].coordinates == Abstract::Point(9, 6));
+    BOOST_REQUIRE(map.bacteria[1].mass == DEFAULT_MASS);
+    BOOST_REQUIRE(map.bacteria[1].instruction == 4);
+    BOOST_REQUIRE(map.bacteria[2].team == 1);
+    Model model(5, 5, 0, 1, 0);
+    model.populate(
+        map.width,
+        map.height,
+        map.teams,
+        map.bacteria,
+        map.seed
+    );
+    BOOST_REQUIRE(model.getTeamsNumber() == 3);
+    BOOST_REQUIRE(model.getAliveTeams() == 3);
+    BOOST_REQUIRE(model.getTeamStats(0).mass == 8);
+    BOOST_REQUIRE(model.getTeamStats(0).clones == 0);
+    Abstract::Point corner(9, 6);
+    BOOST_REQUIRE(model.getInstructionByCoordinates(corner) == 4);
+    BOOST_REQUIRE(model.getTeamByCoordinates(corner) == 2);
+    // invalid maps
+    const char* invalid[] = {
+        "height: 7\nbacteria:\n",
+        "width: 10\nheight: 7\nbacteria:\n  - {x: 1, team: 0}\n",
+        "width: 10\nheight: 7\nbacteria:\n  - {x: 1, y: 1, t: 0}\n",
+        "width: 10\nheight: 7\nbacteria:\n  - {x: 1, y: 1, team: 0\n",
+        "width: 10\nheight: 7\n  - {x: 1, y: 1, team: 0}\n",
+        "width: ten\nheight: 7\n",
+    };
+    for (int i = 0; i < sizeof(invalid) / sizeof(char*); i++) {
+        BOOST_REQUIRE_THROW(readMapText(invalid[i], map), Exception);
+    }
+    // bacteria which can not be placed
+    readMapText(
+        "width: 10\nheight: 7\nteams: 1\nbacteria:\n"
+        "  - {x: 1, y: 1, team: 0}\n  - {x: 1, y: 1, team: 0}\n",
+        map
+    );
+    BOOST_REQUIRE_THROW(model.populate(10, 7, 1, map.bacteria, 0), Exception);
+    map.bacteria.pop_back();
+    // dead bacteria are not allowed
+    map.bacteria[0].mass = 0;
+    BOOST_REQUIRE_THROW(model.populate(10, 7, 1, map.bacteria, 0), Exception);
+    map.bacteria[0].mass = -5;
+    TrustedModel negative(5, 5, 0, 1, 0);
+    BOOST_REQUIRE_THROW(
+        negative.populate(10, 7, 1, map.bacteria, 0),
+        Exception
+    );
+    map.bacteria[0].mass = DEFAULT_MASS;
+    model.populate(10, 7, 1, map.bacteria, 0);
+    BOOST_REQUIRE(model.getTeamStats(0).mass == DEFAULT_MASS);
+    map.bacteria[0].coordinates.x = 10;
+    TrustedModel trusted(5, 5, 0, 1, 0);
+    BOOST_REQUIRE_THROW(
+        trusted.populate(10, 7, 1, map.bacteria, 0),
+        Exception
+    );
+}
+
+BOOST_AUTO_TEST_CASE (map_write_test) {
+    Strings scripts = makeRepeatScripts();
+    Game game(scripts, makeRepeatParams(12));
+    game.run(30);
+    // result is a map of the current board
+    std::stringstream result;
+    writeYamlResult(result, game);
+    BOOST_REQUIRE(result.str().find("moves: 30\n") == 0);
+    GameMap map;
+    readYamlMap(result, map);
+    BOOST_REQUIRE(map.width == 15);
+    BOOST_REQUIRE(map.teams == 2);
+    Game loaded(scripts, map.getParams(), map.bacteria);
+    BOOST_REQUIRE(loaded.getMoveNumber() == 0);
+    Frame expected(15, 12);
+    expected.load(*game.getModel(), 0);
+    Frame actual(15, 12);
+    actual.load(*loaded.getModel(), 0);
+    BOOST_REQUIRE(actual.cells == expected.cells);
+    for (int team = 0; team < 2; team++) {
+        BOOST_REQUIRE(loaded.getTotalMass(team) == game.getTotalMass(team));
+    }
+    // written map is read back
+    std::stringstream text;
+    writeYamlMap(text, *loaded.getModel(), 4000000000u);
+    GameMap copy;
+    readYamlMap(text, copy);
+    BOOST_REQUIRE(copy.seed == 4000000000u);
+    BOOST_REQUIRE(copy.bacteria.size() == map.bacteria.size());
+    loaded.run(10);
+    BOOST_REQUIRE(loaded.getMoveNumber() == 10);
+}
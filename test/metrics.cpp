@@ -0,0 +1,193 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include "Metrics.hpp"
+#include "BatchRunner.hpp"
+#include "Game.hpp"
+
+using namespace Implementation;
+
+static int connectTo(int port) {
+    int client = socket(AF_INET, SOCK_STREAM, 0);
+    BOOST_REQUIRE(client >= 0);
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    BOOST_REQUIRE(connect(client, (sockaddr*)&address,
+                          sizeof(address)) == 0);
+    return client;
+}
+
+static std::string httpGet(int port, const std::string& path) {
+    int client = connectTo(port);
+    std::string request = "GET " + path + " HTTP/1.0\r\n\r\n";
+    BOOST_REQUIRE(send(client, request.data(), request.size(), 0) ==
+                  request.size());
+    std::string response;
+    char buffer[512];
+    ssize_t received;
+    while ((received = recv(client, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, received);
+    }
+    close(client);
+    return response;
+}
+
+// value of the metric (line "name value") or -1
+static double getValue(const std::string& response, const std::string& name) {
+    std::istringstream lines(response);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, name.size() + 1, name + " ") == 0) {
+            return atof(line.c_str() + name.size() + 1);
+        }
+    }
+    return -1;
+}
+
+// play games until stopped
+static void playGames(std::atomic<bool>& stop) {
+    Strings scripts(2, "eat\nclon\nright\n");
+    while (!stop) {
+        Game game(scripts, GameParams(10, 10, 3));
+        game.run(10);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (metrics_server_test) {
+    BOOST_REQUIRE(!Metrics::isActive());
+    {
+        // moves/sec is sampled every 50 ms
+        Metrics::Server server(0, 50);
+        BOOST_REQUIRE(Metrics::isActive());
+        BOOST_REQUIRE(server.getPort() > 0);
+        std::string before = httpGet(server.getPort(), "/metrics");
+        BOOST_REQUIRE(before.find("HTTP/1.0 200 OK") == 0);
+        double moves = getValue(before, "bacteria_moves_total");
+        double games = getValue(before, "bacteria_games_completed_total");
+        double misses = getValue(
+            before,
+            "bacteria_bytecode_cache_misses_total"
+        );
+        BOOST_REQUIRE(moves >= 0);
+        Strings scripts(2, "eat\nclon\nright\n");
+        BatchJobs jobs(2, BatchJob(scripts, GameParams(10, 10, 3), 10));
+        BatchRunner runner(2);
+        BatchResults results = runner.run(jobs);
+        BOOST_REQUIRE(results[0].moves > 0);
+        std::string after = httpGet(server.getPort(), "/metrics");
+        BOOST_REQUIRE(getValue(after, "bacteria_moves_total") ==
+                      moves + results[0].moves + results[1].moves);
+        BOOST_REQUIRE(getValue(after, "bacteria_games_completed_total") ==
+                      games + 2);
+        BOOST_REQUIRE(getValue(
+            after,
+            "bacteria_bytecode_cache_misses_total"
+        ) == misses + 1);
+        BOOST_REQUIRE(getValue(after, "bacteria_live_bacteria{team=\"1\"}")
+                      >= 0);
+        BOOST_REQUIRE(getValue(after, "bacteria_resident_memory_bytes") > 0);
+        BOOST_REQUIRE(after.find("# TYPE bacteria_moves_total counter") !=
+                      std::string::npos);
+        std::string missing = httpGet(server.getPort(), "/other");
+        BOOST_REQUIRE(missing.find("HTTP/1.0 404") == 0);
+        // moves/sec does not depend on requests
+        std::atomic<bool> stop(false);
+        std::thread player(playGames, std::ref(stop));
+        double rate = 0;
+        for (int i = 0; (i < 100) && (rate <= 0); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            rate = getValue(
+                httpGet(server.getPort(), "/metrics"),
+                "bacteria_moves_per_second"
+            );
+        }
+        stop = true;
+        player.join();
+        BOOST_REQUIRE(rate > 0);
+    }
+    BOOST_REQUIRE(!Metrics::isActive());
+    // metrics are active until the last server is destroyed
+    std::unique_ptr<Metrics::Server> first(new Metrics::Server(0));
+    {
+        Metrics::Server second(0);
+        BOOST_REQUIRE(second.getPort() != first->getPort());
+    }
+    BOOST_REQUIRE(Metrics::isActive());
+    first.reset();
+    BOOST_REQUIRE(!Metrics::isActive());
+}
+
+// value of the live bacteria gauge of the team
+static double getLiveBacteria(int team) {
+    std::ostringstream out;
+    Metrics::write(out, 0);
+    std::ostringstream name;
+    name << "bacteria_live_bacteria{team=\"" << team << "\"}";
+    return getValue(out.str(), name.str());
+}
+
+BOOST_AUTO_TEST_CASE (metrics_live_bacteria_test) {
+    Metrics::Server server(0);
+    // games of other tests are destroyed (the gauge is -1 if
+    // it was not written yet)
+    BOOST_REQUIRE(getLiveBacteria(0) <= 0);
+    Strings scripts(2, "eat\n");
+    // numbers of parallel games are summed
+    std::unique_ptr<Game> first(new Game(scripts, GameParams(10, 10, 3)));
+    Game second(scripts, GameParams(10, 10, 5));
+    first->step();
+    second.step();
+    std::unique_ptr<Game> fork = second.fork(1);
+    BOOST_REQUIRE(getLiveBacteria(0) == 3 + 5);
+    BOOST_REQUIRE(getLiveBacteria(1) == 3 + 5);
+    // destroyed games are removed, forks are counted after a move
+    first.reset();
+    fork->step();
+    BOOST_REQUIRE(getLiveBacteria(0) == 5 + 5);
+}
+
+BOOST_AUTO_TEST_CASE (metrics_slow_client_test) {
+    Metrics::Server server(0);
+    // the client sends a byte every 50 ms and never ends the request
+    int slow = connectTo(server.getPort());
+    std::atomic<bool> stop(false);
+    std::thread sender([&]() {
+        while (!stop) {
+            send(slow, "G", 1, MSG_NOSIGNAL);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // the slow client is dropped after the deadline of its request
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    std::string response = httpGet(server.getPort(), "/metrics");
+    std::chrono::steady_clock::duration time =
+        std::chrono::steady_clock::now() - start;
+    stop = true;
+    sender.join();
+    close(slow);
+    BOOST_REQUIRE(response.find("HTTP/1.0 200 OK") == 0);
+    BOOST_REQUIRE(time < std::chrono::seconds(2));
+}
@@ -6,10 +6,18 @@
  */
 
 #include <boost/foreach.hpp>
+#include <boost/mpl/list.hpp>
 #include <boost/test/unit_test.hpp>
 
 #include "Model.hpp"
 
+// all tests run against both validation policies,
+// error handling is tested for checked model only
+typedef boost::mpl::list <
+    Implementation::Model,
+    Implementation::TrustedModel
+> Models;
+
 typedef int (Implementation::Model::*IntOneArgMethod) (
     const Abstract::Point& coordinates
 ) const;
@@ -207,8 +215,17 @@ static void checkErrorHandling(
     }
 }
 
+// trusted model does not check arguments
+template<typename Func>
+static void checkErrorHandling(
+    Implementation::TrustedModel* /*model*/,
+    Func /*model_method*/,
+    bool /*dead_test*/
+) {
+}
+
 static Abstract::Point createInBaseCoordinates(
-    Implementation::Model* model
+    Abstract::Model* model
 ) {
     Abstract::Point coordinates(0, 0);
     model->createNewByCoordinates(
@@ -221,12 +238,13 @@ static Abstract::Point createInBaseCoordinates(
     return coordinates;
 }
 
-static Implementation::Model* createBaseModel(
+template<typename TModel>
+static TModel* createBaseModel(
     int bacteria = 0,
     int teams = 1
 ) {
-    Implementation::Model* model =
-        Abstract::makeModel<Implementation::Model>(
+    TModel* model =
+        Abstract::makeModel<TModel>(
             MIN_WIDTH,
             MIN_HEIGHT,
             bacteria,
@@ -287,20 +305,24 @@ BOOST_AUTO_TEST_CASE (make_model_test) {
     delete model2;
 }
 
-BOOST_AUTO_TEST_CASE (clear_before_move_test) {
-    Implementation::Model* model = createBaseModel(1, 1);
+BOOST_AUTO_TEST_CASE_TEMPLATE (clear_before_move_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>(1, 1);
     model->kill(0, 0);
-    BOOST_REQUIRE_THROW(model->getBacteriaNumber(0), Exception);
+    if (TModel::Policy::CHECK) {
+        BOOST_REQUIRE_THROW(model->getBacteriaNumber(0), Exception);
+    }
     model->clearBeforeMove(0);
     BOOST_REQUIRE(model->getBacteriaNumber(0) == 0);
     //check error handling
-    BOOST_REQUIRE_THROW(model->clearBeforeMove(-1), Exception);
-    BOOST_REQUIRE_THROW(model->clearBeforeMove(1), Exception);
+    if (TModel::Policy::CHECK) {
+        BOOST_REQUIRE_THROW(model->clearBeforeMove(-1), Exception);
+        BOOST_REQUIRE_THROW(model->clearBeforeMove(1), Exception);
+    }
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (cell_state_coordinates_test) {
-    Implementation::Model* model = createBaseModel();
+BOOST_AUTO_TEST_CASE_TEMPLATE (cell_state_coordinates_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>();
     Abstract::Point coordinates = createInBaseCoordinates(model);
     Abstract::CellState state0 = model->cellState(coordinates);
     Abstract::CellState state1 = model->cellState(
@@ -316,8 +338,8 @@ BOOST_AUTO_TEST_CASE (cell_state_coordinates_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (get_direction_coordinates_test) {
-    Implementation::Model* model = createBaseModel();
+BOOST_AUTO_TEST_CASE_TEMPLATE (get_direction_coordinates_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>();
     Abstract::Point coordinates = createInBaseCoordinates(model);
     int direction = model->getDirectionByCoordinates(coordinates);
     BOOST_REQUIRE(direction == Abstract::LEFT);
@@ -329,8 +351,8 @@ BOOST_AUTO_TEST_CASE (get_direction_coordinates_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (get_mass_coordinates_test) {
-    Implementation::Model* model = createBaseModel();
+BOOST_AUTO_TEST_CASE_TEMPLATE (get_mass_coordinates_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>();
     Abstract::Point coordinates = createInBaseCoordinates(model);
     int mass = model->getMassByCoordinates(coordinates);
     BOOST_REQUIRE(mass == DEFAULT_MASS);
@@ -342,8 +364,8 @@ BOOST_AUTO_TEST_CASE (get_mass_coordinates_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (get_team_coordinates_test) {
-    Implementation::Model* model = createBaseModel();
+BOOST_AUTO_TEST_CASE_TEMPLATE (get_team_coordinates_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>();
     Abstract::Point coordinates = createInBaseCoordinates(model);
     int team = model->getTeamByCoordinates(coordinates);
     BOOST_REQUIRE(team == 0);
@@ -355,36 +377,38 @@ BOOST_AUTO_TEST_CASE (get_team_coordinates_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (width_test) {
-    Implementation::Model* model = createBaseModel();
+BOOST_AUTO_TEST_CASE_TEMPLATE (width_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>();
     BOOST_REQUIRE(model->getWidth() == MIN_WIDTH);
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (height_test) {
-    Implementation::Model* model = createBaseModel();
+BOOST_AUTO_TEST_CASE_TEMPLATE (height_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>();
     BOOST_REQUIRE(model->getHeight() == MIN_HEIGHT);
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (bacteria_number_test) {
-    Implementation::Model* model = createBaseModel();
+BOOST_AUTO_TEST_CASE_TEMPLATE (bacteria_number_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>();
     int bacteria_number = model->getBacteriaNumber(0);
     BOOST_REQUIRE(bacteria_number == 0);
     createInBaseCoordinates(model);
     bacteria_number = model->getBacteriaNumber(0);
     BOOST_REQUIRE(bacteria_number == 1);
-    // range errors
-    BOOST_REQUIRE_THROW(model->getBacteriaNumber(-1), Exception);
-    BOOST_REQUIRE_THROW(model->getBacteriaNumber(1), Exception);
-    // error handling checks (checkDead)
-    model->kill(0, 0);
-    BOOST_REQUIRE_THROW(model->getBacteriaNumber(0), Exception);
+    if (TModel::Policy::CHECK) {
+        // range errors
+        BOOST_REQUIRE_THROW(model->getBacteriaNumber(-1), Exception);
+        BOOST_REQUIRE_THROW(model->getBacteriaNumber(1), Exception);
+        // error handling checks (checkDead)
+        model->kill(0, 0);
+        BOOST_REQUIRE_THROW(model->getBacteriaNumber(0), Exception);
+    }
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (is_alive_test) {
-    Implementation::Model* model = createBaseModel(1, 1);
+BOOST_AUTO_TEST_CASE_TEMPLATE (is_alive_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>(1, 1);
     checkErrorHandling(
         model,
         &Implementation::Model::isAlive,
@@ -396,8 +420,8 @@ BOOST_AUTO_TEST_CASE (is_alive_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (get_instruction_test) {
-    Implementation::Model* model = createBaseModel(1, 1);
+BOOST_AUTO_TEST_CASE_TEMPLATE (get_instruction_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>(1, 1);
     int instruction = model->getInstruction(0, 0);
     BOOST_REQUIRE(instruction == 0);
     checkErrorHandling(
@@ -408,8 +432,8 @@ BOOST_AUTO_TEST_CASE (get_instruction_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (get_coordinates_test) {
-    Implementation::Model* model = createBaseModel();
+BOOST_AUTO_TEST_CASE_TEMPLATE (get_coordinates_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>();
     Abstract::Point coordinates = createInBaseCoordinates(model);
     Abstract::Point derived_coordinates = model->getCoordinates(0, 0);
     BOOST_REQUIRE(derived_coordinates == coordinates);
@@ -421,8 +445,8 @@ BOOST_AUTO_TEST_CASE (get_coordinates_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (get_direction_test) {
-    Implementation::Model* model = createBaseModel();
+BOOST_AUTO_TEST_CASE_TEMPLATE (get_direction_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>();
     createInBaseCoordinates(model);
     int direction = model->getDirection(0, 0);
     BOOST_REQUIRE(direction == Abstract::LEFT);
@@ -434,8 +458,8 @@ BOOST_AUTO_TEST_CASE (get_direction_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (get_mass_test) {
-    Implementation::Model* model = createBaseModel(1, 1);
+BOOST_AUTO_TEST_CASE_TEMPLATE (get_mass_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>(1, 1);
     int mass = model->getMass(0, 0);
     BOOST_REQUIRE(mass == DEFAULT_MASS);
     checkErrorHandling(
@@ -446,8 +470,8 @@ BOOST_AUTO_TEST_CASE (get_mass_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (kill_test) {
-    Implementation::Model* model = createBaseModel();
+BOOST_AUTO_TEST_CASE_TEMPLATE (kill_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>();
     Abstract::Point coordinates = createInBaseCoordinates(model);
     model->kill(0, 0);
     Abstract::CellState state = model->cellState(coordinates);
@@ -464,8 +488,8 @@ BOOST_AUTO_TEST_CASE (kill_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (change_mass_test) {
-    Implementation::Model* model = createBaseModel(1, 1);
+BOOST_AUTO_TEST_CASE_TEMPLATE (change_mass_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>(1, 1);
     model->changeMass(0, 0, 1);
     BOOST_REQUIRE(model->getMass(0, 0) == DEFAULT_MASS + 1);
     model->changeMass(0, 0, -1);
@@ -478,8 +502,8 @@ BOOST_AUTO_TEST_CASE (change_mass_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (set_direction_test) {
-    Implementation::Model* model = createBaseModel(1, 1);
+BOOST_AUTO_TEST_CASE_TEMPLATE (set_direction_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>(1, 1);
     model->setDirection(0, 0, 1);
     BOOST_REQUIRE(model->getDirection(0, 0) == 1);
     checkErrorHandling<IntThreeArgsMethod>(
@@ -490,8 +514,8 @@ BOOST_AUTO_TEST_CASE (set_direction_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (set_instruction_test) {
-    Implementation::Model* model = createBaseModel(1, 1);
+BOOST_AUTO_TEST_CASE_TEMPLATE (set_instruction_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>(1, 1);
     model->setInstruction(0, 0, 1);
     BOOST_REQUIRE(model->getInstruction(0, 0) == 1);
     checkErrorHandling<IntThreeArgsMethod>(
@@ -502,8 +526,8 @@ BOOST_AUTO_TEST_CASE (set_instruction_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (set_coordinates_test) {
-    Implementation::Model* model = createBaseModel();
+BOOST_AUTO_TEST_CASE_TEMPLATE (set_coordinates_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>();
     Abstract::Point coordinates = createInBaseCoordinates(model);
     Abstract::Point new_coordinates(1, 1);
     model->setCoordinates(0, 0, new_coordinates);
@@ -520,8 +544,8 @@ BOOST_AUTO_TEST_CASE (set_coordinates_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (kill_coordinates_test) {
-    Implementation::Model* model = createBaseModel();
+BOOST_AUTO_TEST_CASE_TEMPLATE (kill_coordinates_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>();
     Abstract::Point coordinates = createInBaseCoordinates(model);
     model->killByCoordinates(coordinates);
     Abstract::CellState state = model->cellState(coordinates);
@@ -538,8 +562,8 @@ BOOST_AUTO_TEST_CASE (kill_coordinates_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (change_mass_coordinates_test) {
-    Implementation::Model* model = createBaseModel();
+BOOST_AUTO_TEST_CASE_TEMPLATE (change_mass_coordinates_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>();
     Abstract::Point coordinates = createInBaseCoordinates(model);
     int test_val = 1;
     model->changeMassByCoordinates(coordinates, test_val);
@@ -556,8 +580,8 @@ BOOST_AUTO_TEST_CASE (change_mass_coordinates_test) {
     delete model;
 }
 
-BOOST_AUTO_TEST_CASE (create_coordinates_test) {
-    Implementation::Model* model = createBaseModel();
+BOOST_AUTO_TEST_CASE_TEMPLATE (create_coordinates_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>();
     Abstract::Point coordinates = createInBaseCoordinates(model);
     Abstract::CellState state = model->cellState(coordinates);
     BOOST_REQUIRE(state == Abstract::BACTERIUM);
@@ -568,3 +592,309 @@ BOOST_AUTO_TEST_CASE (create_coordinates_test) {
     );
     delete model;
 }
+
+BOOST_AUTO_TEST_CASE (seed_test) {
+    int bacteria = 10;
+    Implementation::Model* model1 =
+        Abstract::makeModel<Implementation::Model>(
+            MIN_WIDTH,
+            MIN_HEIGHT,
+            bacteria,
+            1,
+            42
+        );
+    Implementation::Model* model2 =
+        Abstract::makeModel<Implementation::Model>(
+            MIN_WIDTH,
+            MIN_HEIGHT,
+            bacteria,
+            1,
+            42
+        );
+    for (int i = 0; i < bacteria; i++) {
+        Abstract::Point p1 = model1->getCoordinates(0, i);
+        Abstract::Point p2 = model2->getCoordinates(0, i);
+        BOOST_REQUIRE(p1 == p2);
+        int d1 = model1->getDirection(0, i);
+        BOOST_REQUIRE(d1 == model2->getDirection(0, i));
+    }
+    BOOST_REQUIRE(model1->random(1000) == model2->random(1000));
+    delete model1;
+    delete model2;
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (get_neighbour_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>();
+    Abstract::Point center(2, 2);
+    BOOST_REQUIRE(model->getNeighbour(center, Abstract::LEFT) ==
+                  Abstract::Point(1, 2));
+    BOOST_REQUIRE(model->getNeighbour(center, Abstract::FORWARD) ==
+                  Abstract::Point(2, 3));
+    BOOST_REQUIRE(model->getNeighbour(center, Abstract::RIGHT) ==
+                  Abstract::Point(3, 2));
+    BOOST_REQUIRE(model->getNeighbour(center, Abstract::BACKWARD) ==
+                  Abstract::Point(2, 1));
+    // border of the board
+    Abstract::Point corner(0, 0);
+    BOOST_REQUIRE(model->getNeighbour(corner, Abstract::LEFT) == corner);
+    BOOST_REQUIRE(model->getNeighbour(corner, Abstract::BACKWARD) ==
+                  corner);
+    Abstract::Point far(MIN_WIDTH - 1, MIN_HEIGHT - 1);
+    BOOST_REQUIRE(model->getNeighbour(far, Abstract::RIGHT) == far);
+    BOOST_REQUIRE(model->getNeighbour(far, Abstract::FORWARD) == far);
+    // error handling
+    if (TModel::Policy::CHECK) {
+        BOOST_REQUIRE_THROW(model->getNeighbour(center, 4), Exception);
+        BOOST_REQUIRE_THROW(
+            model->getNeighbour(Abstract::Point(-1, 0), 0),
+            Exception
+        );
+    }
+    delete model;
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (round_enemy_search_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>(0, 2);
+    Abstract::Point center(0, 2);
+    model->createNewByCoordinates(center, DEFAULT_MASS, 0, 0, 0);
+    Abstract::Point enemy;
+    BOOST_REQUIRE(!model->roundEnemySearch(center, Abstract::FORWARD, 0));
+    // bacterium of the same team is not an enemy
+    model->createNewByCoordinates(
+        Abstract::Point(1, 3),
+        DEFAULT_MASS,
+        0,
+        0,
+        0
+    );
+    BOOST_REQUIRE(!model->roundEnemySearch(center, Abstract::FORWARD, 0));
+    model->createNewByCoordinates(
+        Abstract::Point(0, 1),
+        DEFAULT_MASS,
+        0,
+        1,
+        0
+    );
+    model->createNewByCoordinates(
+        Abstract::Point(1, 2),
+        DEFAULT_MASS,
+        0,
+        1,
+        0
+    );
+    // clockwise round starts from the direction
+    BOOST_REQUIRE(model->roundEnemySearch(
+        center,
+        Abstract::FORWARD,
+        0,
+        &enemy
+    ));
+    BOOST_REQUIRE(enemy == Abstract::Point(1, 2));
+    BOOST_REQUIRE(model->roundEnemySearch(
+        center,
+        Abstract::BACKWARD,
+        0,
+        &enemy
+    ));
+    BOOST_REQUIRE(enemy == Abstract::Point(0, 1));
+    BOOST_REQUIRE(model->roundEnemySearch(
+        center,
+        Abstract::LEFT,
+        0,
+        &enemy
+    ));
+    BOOST_REQUIRE(enemy == Abstract::Point(1, 2));
+    if (TModel::Policy::CHECK) {
+        BOOST_REQUIRE_THROW(
+            model->roundEnemySearch(center, -1, 0),
+            Exception
+        );
+    }
+    delete model;
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (team_stats_test, TModel, Models) {
+    TModel* model = createBaseModel<TModel>(2, 2);
+    BOOST_REQUIRE(model->getAliveTeams() == 2);
+    Abstract::TeamStats stats = model->getTeamStats(1);
+    BOOST_REQUIRE(stats.alive == 2);
+    BOOST_REQUIRE(stats.mass == 2 * DEFAULT_MASS);
+    BOOST_REQUIRE(stats.clones == 0);
+    BOOST_REQUIRE(stats.deaths == 0);
+    model->changeMass(1, 0, 3);
+    Abstract::Point coordinates = model->getCoordinates(1, 1);
+    model->changeMassByCoordinates(coordinates, -2);
+    BOOST_REQUIRE(model->getTeamStats(1).mass == 2 * DEFAULT_MASS + 1);
+    model->kill(1, 0);
+    stats = model->getTeamStats(1);
+    BOOST_REQUIRE(stats.alive == 1);
+    BOOST_REQUIRE(stats.mass == DEFAULT_MASS - 2);
+    BOOST_REQUIRE(stats.deaths == 1);
+    // counters do not need clearBeforeMove()
+    model->killByCoordinates(coordinates);
+    BOOST_REQUIRE(model->getTeamStats(1).alive == 0);
+    BOOST_REQUIRE(model->getTeamStats(1).mass == 0);
+    BOOST_REQUIRE(model->getAliveTeams() == 1);
+    model->clearBeforeMove(1);
+    Abstract::Point empty(0, 0);
+    while (model->cellState(empty) != Abstract::EMPTY) {
+        empty.x++;
+    }
+    model->createNewByCoordinates(empty, 7, 0, 1, 0);
+    stats = model->getTeamStats(1);
+    BOOST_REQUIRE(stats.alive == 1);
+    BOOST_REQUIRE(stats.mass == 7);
+    BOOST_REQUIRE(stats.clones == 1);
+    BOOST_REQUIRE(stats.deaths == 2);
+    BOOST_REQUIRE(model->getAliveTeams() == 2);
+    // counters are cleared by reset()
+    model->reset(MIN_WIDTH, MIN_HEIGHT, 1, 3, 1);
+    BOOST_REQUIRE(model->getAliveTeams() == 3);
+    BOOST_REQUIRE(model->getTeamStats(1).clones == 0);
+    BOOST_REQUIRE(model->getTeamStats(2).alive == 1);
+    if (TModel::Policy::CHECK) {
+        BOOST_REQUIRE_THROW(model->getTeamStats(3), Exception);
+    }
+    delete model;
+}
+
+// offset of the number of teams in the image of Model
+// (magic, version, width and height are before it)
+static const int TEAMS_OFFSET = 4 * 4;
+
+static int getImageInt(const std::string& image, int offset) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= uint32_t((unsigned char)(image[offset + i])) << (8 * i);
+    }
+    return value;
+}
+
+static void setImageInt(std::string& image, int offset, int value) {
+    for (int i = 0; i < 4; i++) {
+        image[offset + i] = char((uint32_t(value) >> (8 * i)) & 0xFF);
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (snapshot_test, TModel, Models) {
+    TModel* model = Abstract::makeModel<TModel>(10, 7, 5, 3, 11);
+    model->changeMass(0, 1, 4);
+    model->setInstruction(1, 2, 3);
+    model->setDirection(2, 0, Abstract::RIGHT);
+    model->kill(1, 0);
+    model->random(100);
+    // dead bacterium of team 1 is kept in the image
+    std::string image = model->snapshot();
+    TModel* copy = createBaseModel<TModel>(1, 1);
+    copy->restore(image);
+    BOOST_REQUIRE(copy->snapshot() == image);
+    BOOST_REQUIRE(copy->getWidth() == 10);
+    BOOST_REQUIRE(copy->getHeight() == 7);
+    BOOST_REQUIRE(!copy->isAlive(1, 0));
+    copy->clearBeforeMove(1);
+    model->clearBeforeMove(1);
+    BOOST_REQUIRE(copy->getBacteriaNumber(1) == 4);
+    BOOST_REQUIRE(copy->getInstruction(1, 1) == 3);
+    BOOST_REQUIRE(copy->getMass(0, 1) == DEFAULT_MASS + 4);
+    Abstract::Point coordinates = model->getCoordinates(2, 0);
+    BOOST_REQUIRE(copy->getDirectionByCoordinates(coordinates) ==
+                  Abstract::RIGHT);
+    Abstract::TeamStats stats = copy->getTeamStats(1);
+    BOOST_REQUIRE(stats.alive == 4);
+    BOOST_REQUIRE(stats.deaths == 1);
+    BOOST_REQUIRE(copy->getAliveTeams() == 3);
+    for (int i = 0; i < 10; i++) {
+        BOOST_REQUIRE(copy->random(1000) == model->random(1000));
+    }
+    // invalid images
+    std::string truncated = image.substr(0, image.size() - 1);
+    BOOST_REQUIRE_THROW(copy->restore(truncated), Exception);
+    std::string corrupted = image;
+    corrupted[0] = 'X';
+    BOOST_REQUIRE_THROW(copy->restore(corrupted), Exception);
+    BOOST_REQUIRE_THROW(copy->restore(image + "x"), Exception);
+    // huge number of teams is rejected before allocation
+    std::string many_teams = image;
+    setImageInt(many_teams, TEAMS_OFFSET, 1 << 28);
+    BOOST_REQUIRE_THROW(copy->restore(many_teams), Exception);
+    // slot of the dead bacterium is free, a live one must not be free
+    int units_offset = TEAMS_OFFSET + 4 + Random::STATE_SIZE * 4;
+    int units_number = getImageInt(image, units_offset);
+    int free_offset = units_offset + 4 + units_number * 6 * 4;
+    BOOST_REQUIRE(getImageInt(image, free_offset) == 1);
+    int first_team = free_offset + 4 + 4;
+    int live_slot = getImageInt(image, first_team + 4);
+    std::string used_free = image;
+    setImageInt(used_free, free_offset + 4, live_slot);
+    BOOST_REQUIRE_THROW(copy->restore(used_free), Exception);
+    // fields of a live bacterium: mass, direction, instruction
+    int live_unit = units_offset + 4 + live_slot * 6 * 4;
+    std::string no_mass = image;
+    setImageInt(no_mass, live_unit + 2 * 4, 0);
+    BOOST_REQUIRE_THROW(copy->restore(no_mass), Exception);
+    std::string bad_direction = image;
+    setImageInt(bad_direction, live_unit + 3 * 4, 4);
+    BOOST_REQUIRE_THROW(copy->restore(bad_direction), Exception);
+    std::string bad_instruction = image;
+    setImageInt(bad_instruction, live_unit + 5 * 4, -1);
+    BOOST_REQUIRE_THROW(copy->restore(bad_instruction), Exception);
+    // dead counter must match the list of bacteria
+    int first_dead = first_team + 4 + getImageInt(image, first_team) * 4;
+    BOOST_REQUIRE(getImageInt(image, first_dead) == 0);
+    std::string bad_dead = image;
+    setImageInt(bad_dead, first_dead, 1);
+    BOOST_REQUIRE_THROW(copy->restore(bad_dead), Exception);
+    // failed restore does not change the model
+    TModel* other = Abstract::makeModel<TModel>(6, 5, 2, 1, 3);
+    std::string other_image = other->snapshot();
+    BOOST_REQUIRE_THROW(other->restore(bad_dead), Exception);
+    BOOST_REQUIRE(other->snapshot() == other_image);
+    delete other;
+    copy->restore(image);
+    delete copy;
+    delete model;
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (fork_test, TModel, Models) {
+    TModel* model = Abstract::makeModel<TModel>(40, 40, 100, 2, 3);
+    ModelPtr fork = model->fork();
+    std::string image = model->snapshot();
+    BOOST_REQUIRE(fork->snapshot() == image);
+    // changes of the fork do not change the original
+    Abstract::Point coordinates = fork->getCoordinates(0, 0);
+    fork->kill(0, 0);
+    fork->clearBeforeMove(0);
+    fork->changeMass(1, 5, 10);
+    BOOST_REQUIRE(model->cellState(coordinates) == Abstract::BACTERIUM);
+    BOOST_REQUIRE(fork->cellState(coordinates) == Abstract::EMPTY);
+    BOOST_REQUIRE(model->snapshot() == image);
+    // and vice versa
+    std::string fork_image = fork->snapshot();
+    model->setDirection(1, 5, Abstract::BACKWARD);
+    model->changeMass(1, 5, -1);
+    BOOST_REQUIRE(fork->snapshot() == fork_image);
+    BOOST_REQUIRE(fork->getMass(1, 5) == model->getMass(1, 5) + 11);
+    BOOST_REQUIRE(fork->getTeamStats(0).alive == 99);
+    BOOST_REQUIRE(model->getTeamStats(0).alive == 100);
+    // fork of a fork
+    ModelPtr fork2 = fork->fork();
+    BOOST_REQUIRE(fork2->snapshot() == fork_image);
+    // forks reseeded with different seeds have different sequences,
+    // the same seed repeats the sequence
+    fork->reseed(1);
+    fork2->reseed(2);
+    ModelPtr fork3 = model->fork();
+    fork3->reseed(1);
+    int differences = 0;
+    for (int i = 0; i < 10; i++) {
+        int value = fork->random(1000);
+        BOOST_REQUIRE(fork3->random(1000) == value);
+        if (fork2->random(1000) != value) {
+            differences++;
+        }
+    }
+    BOOST_REQUIRE(differences > 0);
+    // the board is not changed by reseed()
+    BOOST_REQUIRE(fork2->getMass(1, 5) == model->getMass(1, 5) + 11);
+    delete model;
+}
@@ -0,0 +1,61 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <sstream>
+
+#include <boost/test/unit_test.hpp>
+
+#include "Game.hpp"
+#include "InstructionProfile.hpp"
+
+using namespace Implementation;
+
+// empty lines are not instructions
+static const char* const SCRIPT = "eat\n\nj 0\nstr\n";
+
+BOOST_AUTO_TEST_CASE (source_lines_test) {
+    Ints lines = Bytecode::getSourceLines(SCRIPT);
+    BOOST_REQUIRE(lines.size() == 3);
+    BOOST_REQUIRE(lines[0] == 1);
+    BOOST_REQUIRE(lines[1] == 3);
+    BOOST_REQUIRE(lines[2] == 4);
+    BOOST_REQUIRE(Bytecode::getSourceLines("\n\ngo").size() == 1);
+    BOOST_REQUIRE(Bytecode::getSourceLines("\n\ngo")[0] == 3);
+}
+
+BOOST_AUTO_TEST_CASE (instruction_profile_test) {
+    Strings scripts(2, SCRIPT);
+    Game game(scripts, GameParams(10, 10, 3));
+    InstructionProfile profile;
+    game.setProfile(&profile);
+    BOOST_REQUIRE(profile.getTeamsNumber() == 2);
+    BOOST_REQUIRE(profile.getInstructionsNumber(0) == 3);
+    game.run(4);
+    // a move is "j 0" and "eat" (except the first one),
+    // "str" is never reached
+    for (int team = 0; team < 2; team++) {
+        BOOST_REQUIRE(profile.getDispatches(team, 0) == 4 * 3);
+        BOOST_REQUIRE(profile.getDispatches(team, 1) == 3 * 3);
+        BOOST_REQUIRE(profile.getDispatches(team, 2) == 0);
+        BOOST_REQUIRE(profile.getCycles(team, 2) == 0);
+    }
+    std::ostringstream report;
+    writeProfileReport(report, profile, 0, SCRIPT);
+    std::string text = report.str();
+    BOOST_REQUIRE(text.find("57.1%") != std::string::npos);
+    BOOST_REQUIRE(text.find("    2 ") != std::string::npos);
+    BOOST_REQUIRE(text.find("str") != std::string::npos);
+    BOOST_REQUIRE_THROW(
+        writeProfileReport(report, profile, 0, "eat\n"),
+        Exception
+    );
+    // profiling stops
+    game.setProfile(NULL);
+    uint64_t eats = profile.getDispatches(0, 0);
+    game.run(1);
+    BOOST_REQUIRE(profile.getDispatches(0, 0) == eats);
+}
@@ -0,0 +1,49 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "random.hpp"
+
+BOOST_AUTO_TEST_CASE (random_range_test) {
+    Random random(1);
+    for (int i = 0; i < 1000; i++) {
+        BOOST_REQUIRE(random.next(4) < 4);
+        BOOST_REQUIRE(random.next(1) == 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (random_seed_test) {
+    Random random1(42);
+    Random random2(42);
+    Random random3(43);
+    bool differs = false;
+    for (int i = 0; i < 100; i++) {
+        unsigned int value = random1.next(1000);
+        BOOST_REQUIRE(value == random2.next(1000));
+        if (value != random3.next(1000)) {
+            differs = true;
+        }
+    }
+    BOOST_REQUIRE(differs);
+    // restart the sequence
+    random1.seed(7);
+    random2.seed(7);
+    BOOST_REQUIRE(random1.next(1000) == random2.next(1000));
+}
+
+BOOST_AUTO_TEST_CASE (random_state_test) {
+    Random random1(5);
+    random1.next(10);
+    uint32_t state[Random::STATE_SIZE];
+    random1.getState(state);
+    Random random2;
+    random2.setState(state);
+    for (int i = 0; i < 100; i++) {
+        BOOST_REQUIRE(random1.next(1000) == random2.next(1000));
+    }
+}
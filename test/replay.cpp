@@ -0,0 +1,89 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "Replay.hpp"
+#include "TestGames.hpp"
+
+using namespace Implementation;
+
+static Replay recordReplay(int moves) {
+    ReplayRecorder recorder(makeRepeatScripts(), makeRepeatParams(), 25);
+    BOOST_REQUIRE(recorder.run(moves) == moves);
+    return recorder.getReplay();
+}
+
+BOOST_AUTO_TEST_CASE (replay_record_test) {
+    Replay replay = recordReplay(120);
+    BOOST_REQUIRE(replay.getMovesNumber() == 120);
+    // after moves 0, 25, 50, 75, 100
+    BOOST_REQUIRE(replay.keyframes.size() == 5);
+    Replay copy = Replay::make(replay.serialize());
+    BOOST_REQUIRE(copy.hashes == replay.hashes);
+    BOOST_REQUIRE(copy.keyframes == replay.keyframes);
+    BOOST_REQUIRE(copy.scripts == replay.scripts);
+    BOOST_REQUIRE(copy.params.seed == 9);
+    std::string data = replay.serialize();
+    BOOST_REQUIRE_THROW(
+        Replay::make(data.substr(0, data.size() - 1)),
+        Exception
+    );
+}
+
+BOOST_AUTO_TEST_CASE (replay_seek_test) {
+    Replay replay = recordReplay(120);
+    // verification mode throws on mismatch
+    ReplayPlayer player(replay, true);
+    player.seek(73);
+    BOOST_REQUIRE(player.getMoveNumber() == 73);
+    BOOST_REQUIRE(player.getGame().getStateHash() == replay.hashes[73]);
+    player.seek(10);
+    player.seek(120);
+    BOOST_REQUIRE(!player.step());
+    player.seek(99);
+    BOOST_REQUIRE(player.step());
+    BOOST_REQUIRE(player.getMoveNumber() == 100);
+    BOOST_REQUIRE_THROW(player.seek(121), Exception);
+    BOOST_REQUIRE(player.verify() == -1);
+}
+
+BOOST_AUTO_TEST_CASE (replay_verify_test) {
+    Replay replay = recordReplay(60);
+    replay.hashes[42]++;
+    ReplayPlayer player(replay);
+    BOOST_REQUIRE(player.verify() == 42);
+    ReplayPlayer verifier(replay, true);
+    verifier.seek(41);
+    BOOST_REQUIRE_THROW(verifier.seek(45), Exception);
+}
+
+BOOST_AUTO_TEST_CASE (replay_map_test) {
+    Strings scripts = makeRepeatScripts();
+    UnitList bacteria;
+    bacteria.push_back(Unit(Abstract::Point(1, 1), 7, 0, 0, 0));
+    bacteria.push_back(Unit(Abstract::Point(9, 9), 3, 2, 1, 0));
+    GameParams params(10, 10, 0, 4);
+    ReplayRecorder recorder(scripts, params, 10, bacteria);
+    recorder.run(30);
+    Replay replay = Replay::make(recorder.getReplay().serialize());
+    BOOST_REQUIRE(replay.bacteria.size() == 2);
+    BOOST_REQUIRE(replay.bacteria[1].coordinates == Abstract::Point(9, 9));
+    BOOST_REQUIRE(replay.bacteria[1].mass == 3);
+    BOOST_REQUIRE(replay.bacteria[1].direction == 2);
+    BOOST_REQUIRE(replay.bacteria[1].team == 1);
+    Game game(scripts, params, bacteria);
+    BOOST_REQUIRE(replay.hashes[0] == game.getStateHash());
+    // initial state is made from the map, not from the seed
+    BOOST_REQUIRE(replay.hashes[0] !=
+                  Game(scripts, GameParams(10, 10, 2, 4)).getStateHash());
+    ReplayPlayer player(replay, true);
+    BOOST_REQUIRE(player.verify() == -1);
+    player.seek(replay.getMovesNumber());
+    BOOST_REQUIRE(player.getGame().getStateHash() ==
+                  recorder.getGame().getStateHash());
+}
@@ -0,0 +1,80 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "Tournament.hpp"
+
+using namespace Implementation;
+
+static Strings makeScripts() {
+    Strings scripts;
+    scripts.push_back("go\nje 3\nright 2\nstr\nclon\nj 0\n");
+    scripts.push_back("back\ngo r\nje 0\nstr\neat r\nclon\nturn r\n");
+    scripts.push_back("eat 3\nclon\ngo\nleft\n");
+    scripts.push_back("eat\n");
+    return scripts;
+}
+
+BOOST_AUTO_TEST_CASE (tournament_schedule_test) {
+    TournamentParams params(GameParams(6, 6, 2, 7), 3, 50, 3);
+    Tournament tournament(makeScripts(), params);
+    // 6 pairs and 4 free-for-all games for every seed
+    // (12 places of 3 teams, 3 games of every script)
+    BOOST_REQUIRE(tournament.getJobs().size() == 3 * (6 + 4));
+    BOOST_REQUIRE(tournament.getParticipants(0) == Ints({0, 1}));
+    // sides are swapped for the next seed
+    BOOST_REQUIRE(tournament.getParticipants(6) == Ints({1, 0}));
+    BOOST_REQUIRE(tournament.getJobs()[6].params.seed == 8);
+    BOOST_REQUIRE(tournament.getParticipants(18).size() == 3);
+    Ints ffa_games(4, 0);
+    for (int job = 18; job < tournament.getJobs().size(); job++) {
+        const Ints& participants = tournament.getParticipants(job);
+        BOOST_REQUIRE(participants.size() == 3);
+        for (int team = 0; team < 3; team++) {
+            ffa_games[participants[team]]++;
+        }
+    }
+    BOOST_REQUIRE(ffa_games == Ints(4, 3 * 3));
+    BOOST_REQUIRE_THROW(Tournament(makeScripts(), TournamentParams(
+        GameParams(6, 6, 2, 7), 1, 50, 5
+    )), Exception);
+}
+
+BOOST_AUTO_TEST_CASE (tournament_results_test) {
+    Strings scripts = makeScripts();
+    TournamentParams params(GameParams(6, 6, 2, 7), 4, 50, 3);
+    Tournament t1(scripts, params);
+    Tournament t2(scripts, params);
+    BatchRunner r1(1);
+    BatchRunner r3(3);
+    int progress = 0;
+    t1.run(r1);
+    t2.run(r3, [&](int job, const BatchResult& result) {
+        progress++;
+    });
+    int games = t1.getJobs().size();
+    BOOST_REQUIRE(progress == games);
+    BOOST_REQUIRE(t2.getFinishedGames() == games);
+    int total_games = 0;
+    int total_wins = 0;
+    for (int s = 0; s < scripts.size(); s++) {
+        const TournamentScore& score = t1.getScore(s);
+        BOOST_REQUIRE(score.wins + score.losses + score.draws == score.games);
+        BOOST_REQUIRE(score.wins == t2.getScore(s).wins);
+        BOOST_REQUIRE(score.mass == t2.getScore(s).mass);
+        total_games += score.games;
+        total_wins += score.wins;
+        for (int s2 = 0; s2 < scripts.size(); s2++) {
+            BOOST_REQUIRE(t1.getPairWins(s, s2) == t2.getPairWins(s, s2));
+        }
+    }
+    // every pairing game has 2 participants, free-for-all has 3
+    BOOST_REQUIRE(total_games == 4 * (6 * 2 + 4 * 3));
+    BOOST_REQUIRE(total_wins <= games);
+    BOOST_REQUIRE(t1.getRanking() == t2.getRanking());
+}
@@ -0,0 +1,54 @@
+/*
+ * bacteria-core, core for cellular automaton
+ * Copyright (C) 2016 Pavel Dolgov
+ *
+ * See the LICENSE file for terms of use.
+ */
+
+#include <sstream>
+
+#include <boost/test/unit_test.hpp>
+
+#include "Trace.hpp"
+#include "Exception.hpp"
+#include "Game.hpp"
+
+using namespace Implementation;
+
+static const char* const SCRIPT = "je 4\neat 5\ngo\nj 0\nstr\n";
+
+BOOST_AUTO_TEST_CASE (trace_test) {
+    Trace::start();
+    {
+        Game game(Strings(2, SCRIPT), GameParams(10, 10, 3));
+        game.run(3);
+    }
+    Trace::stop();
+    long long events = Trace::getEventsNumber();
+    // 3 moves of 2 teams of 3 bacteria (at least)
+    BOOST_REQUIRE(events >= 3 + 3 * 2 * 4);
+    std::ostringstream out;
+    Trace::write(out);
+    std::string json = out.str();
+    BOOST_REQUIRE(json.find("{\"traceEvents\":[") == 0);
+    BOOST_REQUIRE(json.find("\"name\":\"Changer construction\"") !=
+                  std::string::npos);
+    BOOST_REQUIRE(json.find("\"name\":\"clearBeforeMove\"") !=
+                  std::string::npos);
+    BOOST_REQUIRE(json.find("\"name\":\"compaction\"") !=
+                  std::string::npos);
+    BOOST_REQUIRE(json.find("\"name\":\"bacterium\"") != std::string::npos);
+    BOOST_REQUIRE(json.find("\"name\":\"move\"") != std::string::npos);
+    BOOST_REQUIRE(json.find("]}") != std::string::npos);
+    // nothing is recorded when tracing is stopped
+    Game game(Strings(2, SCRIPT), GameParams(10, 10, 3));
+    game.run(3);
+    BOOST_REQUIRE(Trace::getEventsNumber() == events);
+    Trace::start();
+    // events are read only after stop()
+    BOOST_REQUIRE_THROW(Trace::getEventsNumber(), Exception);
+    BOOST_REQUIRE_THROW(Trace::getDroppedEvents(), Exception);
+    BOOST_REQUIRE_THROW(Trace::write(out), Exception);
+    Trace::stop();
+    BOOST_REQUIRE(Trace::getEventsNumber() == 0);
+}